@@ -38,6 +38,13 @@ BitmapSource::BitmapSource(const QString & filename, FREE_IMAGE_FORMAT fif)
     if (nullptr == mBitmap) {
         throw std::runtime_error("BitmapSource[BitmapSource]: Failed to load file.");
     }
+#if SHIBAVIEW_APPLICATION
+    // Floating point frames which are exact in half precision, e.g. most of EXR renders, take half of the memory
+    if (FIBITMAP* half = FreeImageExt_ConvertToHalf(mBitmap)) {
+        FreeImage_Unload(mBitmap);
+        mBitmap = half;
+    }
+#endif
 }
 
 BitmapSource::~BitmapSource()
@@ -18,8 +18,11 @@
 
 #include "CanvasWidget.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstdio>
 #include <iostream>
+#include <utility>
 
 #include <QAction>
 #include <QApplication>
@@ -44,6 +47,7 @@
 #include "AboutWidget.h"
 #include "Controls.h"
 #include "ExifWidget.h"
+#include "GLCanvas.h"
 #include "Global.h"
 #include "Image.h"
 #include "ImageLoader.h"
@@ -51,9 +55,12 @@
 #include "ImageProcessor.h"
 #include "ImageSource.h"
 #include "HistogramWidget.h"
+#include "MenuSliderWidget.h"
 #include "MenuWidget.h"
 #include "Settings.h"
 #include "TextWidget.h"
+#include "TileCache.h"
+#include "ToneMapping.h"
 #include "Tooltip.h"
 #include "ZoomController.h"
 #include "UniqueTick.h"
@@ -85,6 +92,7 @@ namespace
     const QString kSettingsGeometry    = "canvas/geometry";
     const QString kSettingsFullscreen  = "canvas/fullscreen";
     const QString kSettingsShowInfo    = "canvas/info";
+    const QString kSettingsShowStats   = "canvas/statistics";
     const QString kSettingsZoomMode    = "canvas/zoom";
     const QString kSettingsRememberZoom = "canvas/remember_zoom";
     const QString kSettingsZoomScaleValue = "canvas/zoom_scale";
@@ -99,6 +107,21 @@ namespace
 
     Q_CONSTEXPR int kToolbarHeight = 24;
 
+    // Upper bound for the preview size, keeps feedback within a frame
+    Q_CONSTEXPR qreal kPreviewMaxPixels = 512.0 * 512.0;
+
+    // Larger frames are processed only in the visible region and screen resolution
+    Q_CONSTEXPR qreal kViewportMinPixels = 4096.0 * 4096.0;
+
+    // Milliseconds, if the refresh rate of the screen is unknown
+    Q_CONSTEXPR int kDefaultFrameInterval = 16;
+
+    // Part of the frame interval, which a paint of the moving view may take
+    Q_CONSTEXPR double kMotionFrameBudget = 0.5;
+
+    // Frame intervals without a buffer swap, after which the timer ticks instead
+    Q_CONSTEXPR int kSwapTimeoutFrames = 2;
+
     Q_CONSTEXPR
     BorderPosition operator|(const BorderPosition & lh, const BorderPosition & rh)
     {
@@ -162,15 +185,22 @@ CanvasWidget::CanvasWidget(std::chrono::steady_clock::time_point t)
     mPageText = new TextWidget(this);
     mPageText->enableShadow();
 
+    mStatsText = new TextWidget(this);
+    mStatsText->enableShadow();
+    mStatsText->hide();
+
     mErrorText = new TextWidget(this);
     mErrorText->setColor(Qt::white);    // background is always black
 
+    updateCanvasBackend();
+
     const auto kDefaultGeometry = QRect(200, 200, 1280, 720);
 
     QSettings settings;
     mClickGeometry = settings.value(kSettingsGeometry, kDefaultGeometry).toRect();
     mFullScreen    = settings.value(kSettingsFullscreen, false).toBool();
     mShowInfo      = settings.value(kSettingsShowInfo, false).toBool();
+    mShowStats     = settings.value(kSettingsShowStats, false).toBool();
     mFilteringMode = toFilteringMode(settings.value(kSettingsFilterMode, static_cast<int32_t>(FilteringMode::eNone)).toInt());
     mRememberZoom  = settings.value(kSettingsRememberZoom, false).toBool();
     if (mRememberZoom) {
@@ -192,11 +222,28 @@ CanvasWidget::CanvasWidget(std::chrono::steady_clock::time_point t)
     mImageDescription = std::make_unique<ImageDescription>();
     mDisplayFullPath = settings.value(kSettingsFullPath, false).toBool();
 
+    mPerformanceStats = std::make_unique<PerformanceStats>();
+
     mImageProcessor = std::make_unique<ImageProcessor>();
+    mImageProcessor->setResultCallback([this]() {
+        QMetaObject::invokeMethod(this, [this]() { updateImage(); }, Qt::QueuedConnection);
+    });
+    mTileCache = std::make_unique<TileCache>([this]() {
+        QMetaObject::invokeMethod(this, [this]() { updateImage(); }, Qt::QueuedConnection);
+    });
     mImageProcessor->setToneMappingMode(static_cast<FREE_IMAGE_TMO>(settings.value(kSettingsToneMapping, static_cast<int32_t>(FITMO_CLAMP)).toInt()));
 
     mZoomController = std::make_unique<ZoomController>(16, settings.value(kSettingsZoomFitValue, 128).toInt(), settings.value(kSettingsZoomScaleValue, 0).toInt());
 
+    mFrameTimer = new QTimer(this);
+    mFrameTimer->setTimerType(Qt::PreciseTimer);
+    mFrameTimer->setInterval(kDefaultFrameInterval);
+    connect(mFrameTimer, &QTimer::timeout, this, &CanvasWidget::onFrameTick);
+
+    mTooltipTimer = new QTimer(this);
+    mTooltipTimer->setSingleShot(true);
+    connect(mTooltipTimer, &QTimer::timeout, this, &CanvasWidget::updateTooltip);
+
     connect(static_cast<QApplication*>(QApplication::instance()), &QApplication::applicationStateChanged, this, &CanvasWidget::applicationStateChanged);
 
     mShowTransparencyCheckboard = settings.value(kSettingsCheckboard, mShowTransparencyCheckboard).toBool();
@@ -237,6 +284,7 @@ CanvasWidget::~CanvasWidget()
         settings.setValue(kSettingsGeometry,   mClickGeometry);
         settings.setValue(kSettingsFullscreen, mFullScreen);
         settings.setValue(kSettingsShowInfo,   mShowInfo);
+        settings.setValue(kSettingsShowStats,  mShowStats);
         settings.setValue(kSettingsFilterMode, static_cast<int32_t>(mFilteringMode));
         settings.setValue(kSettingsRememberZoom, mRememberZoom);
         if (mRememberZoom) {
@@ -378,6 +426,19 @@ QMenu* CanvasWidget::createContextMenu()
             for (int32_t i = 0; i < tmActions.size(); ++i) {
                 tmActions[i]->setChecked(static_cast<FREE_IMAGE_TMO>(i) == mImageProcessor->toneMappingMode());
             }
+            tmMenu->addSeparator();
+            for (size_t i = 0; i < mActToneMappingParams.size(); ++i) {
+                if (!mActToneMappingParams[i]) {
+                    mToneMappingSliders[i] = new MenuSliderWidget();
+                    connect(mToneMappingSliders[i], &MenuSliderWidget::pressed,  this, &CanvasWidget::onToneMappingSliderPressed);
+                    connect(mToneMappingSliders[i], &MenuSliderWidget::moved,    this, &CanvasWidget::onToneMappingSliderMoved);
+                    connect(mToneMappingSliders[i], &MenuSliderWidget::released, this, &CanvasWidget::onToneMappingSliderReleased);
+                    mActToneMappingParams[i] = new QWidgetAction(this);
+                    mActToneMappingParams[i]->setDefaultWidget(mToneMappingSliders[i]);
+                }
+                tmMenu->addAction(mActToneMappingParams[i]);
+            }
+            updateToneMappingSliders();
             tmAction->setEnabled(true);
         }
         else {
@@ -604,6 +665,26 @@ CanvasWidget::ActionsArray<ChannelSwizzle> CanvasWidget::initSwizzleActions()
     return actions;
 }
 
+void CanvasWidget::updateToneMappingSliders()
+{
+    const auto params = ToneMapping::parameters(mImageProcessor->toneMappingMode());
+    // Both zero mean default parameters
+    const bool useDefaults = (mImageProcessor->toneMappingFirst() == 0.0 && mImageProcessor->toneMappingSecond() == 0.0);
+    const std::array<double, 2> values = { mImageProcessor->toneMappingFirst(), mImageProcessor->toneMappingSecond() };
+    for (size_t i = 0; i < mActToneMappingParams.size(); ++i) {
+        if (!mActToneMappingParams[i]) {
+            continue;
+        }
+        if (i < params.size()) {
+            mToneMappingSliders[i]->setup(QString::fromUtf8(params[i].name), params[i].min, params[i].max, useDefaults ? params[i].defaultValue : values[i]);
+            mActToneMappingParams[i]->setVisible(true);
+        }
+        else {
+            mActToneMappingParams[i]->setVisible(false);
+        }
+    }
+}
+
 void CanvasWidget::onShowContextMenu(const QPoint & p)
 {
     try {
@@ -623,12 +704,64 @@ void CanvasWidget::onShowContextMenu(const QPoint & p)
 void CanvasWidget::invalidateImageDescription()
 {
     mInfoIsValid = false;
-    update();
+    updateOverlays();
+}
+
+void CanvasWidget::updateOverlays()
+{
+    if (!mInfoText || !mPageText) {
+        return;
+    }
+    if (mShowInfo) {
+        if (!mInfoIsValid) {
+            if (mInfoText && mImageDescription) {
+                mInfoText->setText(mImageDescription->toLines(mDisplayFullPath));
+            }
+            mInfoIsValid = true;
+        }
+        mInfoText->show();
+        if (mImage && mImage->notNull() && (mImage->pagesCount() > 1)) {
+            mPageText->show();
+        }
+        else {
+            mPageText->hide();
+        }
+    }
+    else {
+        mInfoText->hide();
+        mPageText->hide();
+    }
+}
+
+void CanvasWidget::updateImage()
+{
+    if (!mImage || mImage->isNull() || !mZoomController) {
+        update();
+        return;
+    }
+    const QRect region = displayedImageRegion() & rect();
+    if (!region.isEmpty()) {
+        update(region);
+    }
+}
+
+void CanvasWidget::updatePageImage(const QRect& previousRegion)
+{
+    if (!mImage || mImage->isNull() || !mZoomController) {
+        update();
+        return;
+    }
+    const QRect region = (displayedImageRegion() | previousRegion) & rect();
+    if (!region.isEmpty()) {
+        update(region);
+    }
 }
 
 void CanvasWidget::onImageReady(const ImageLoadResult& result)
 {
     mImageProcessor->detachSource();
+    mToneMappingPreview = false;
+    mKeepPreview = false;
 
     if (mContextMenu) {
         delete mContextMenu;
@@ -638,6 +771,8 @@ void CanvasWidget::onImageReady(const ImageLoadResult& result)
     mEnableAnimation = false;
     mAnimIndex = kNoneIndex;
 
+    mPerformanceStats->reset();
+
     mImage = result.image;
     if (mImage) {
         mImageDescription->setImageInfo(mImage->info());
@@ -818,6 +953,80 @@ QRect CanvasWidget::calculateImageRegion() const
     return r;
 }
 
+QRect CanvasWidget::displayedImageRegion() const
+{
+    if (mViewAnimation.isZooming()) {
+        return mViewAnimation.zoomRect(ViewAnimation::Clock::now()).toRect();
+    }
+    return calculateImageRegion();
+}
+
+bool CanvasWidget::isViewMoving() const
+{
+    return mViewAnimation.isActive() || (mBrowsing && mClickPos != mMenuPos);
+}
+
+bool CanvasWidget::isPacedBySwaps() const
+{
+    return mGLCanvas && mGLCanvas->isVisible();
+}
+
+void CanvasWidget::startFrameLoop()
+{
+    if (!mFrameTimer->isActive()) {
+        // Animations depend on time only, so ticks may come from either source
+        mFrameTimer->setInterval(isPacedBySwaps() ? kSwapTimeoutFrames * frameInterval() : frameInterval());
+        mFrameTimer->start();
+    }
+}
+
+void CanvasWidget::onFrameSwapped()
+{
+    if (mFrameTimer->isActive()) {
+        // Swaps wait for the vertical blank, the timer is restarted and only covers a missing swap
+        mFrameTimer->start();
+        onFrameTick();
+    }
+}
+
+int CanvasWidget::frameInterval() const
+{
+    const qreal refreshRate = screen() ? screen()->refreshRate() : 0.0;
+    return (refreshRate > 0.0) ? std::max(1, qRound(1000.0 / refreshRate)) : kDefaultFrameInterval;
+}
+
+void CanvasWidget::onFrameTick()
+{
+    if (mPendingZoomSteps != 0) {
+        zoomToTarget(mPendingZoomTarget, std::exchange(mPendingZoomSteps, 0));
+    }
+    const auto now = ViewAnimation::Clock::now();
+    if (mViewAnimation.isPanning()) {
+        const QPoint step = mViewAnimation.panStep(now);
+        if (!step.isNull()) {
+            const QPoint prevOffset = mOffset;
+            mOffset += step;
+            updateOffsets();
+            if (mOffset == prevOffset) {
+                // Reached the border
+                mViewAnimation.stopPan();
+            }
+        }
+    }
+    mViewAnimation.advance(now);
+    if (!mViewAnimation.isActive()) {
+        mFrameTimer->stop();
+        mMotionOverBudget = false;
+        invalidateTooltip();
+    }
+    else {
+        // The backend may change while the view moves
+        mFrameTimer->setInterval(isPacedBySwaps() ? kSwapTimeoutFrames * frameInterval() : frameInterval());
+    }
+    // The last frame is drawn in high quality
+    update();
+}
+
 void CanvasWidget::updateZoomLabel()
 {
     if (mZoomController && mImageDescription) {
@@ -832,11 +1041,161 @@ void CanvasWidget::repositionPageText()
     mPageText->move(kTextPaddingLeft, height() - mPageText->height() * 2);
 }
 
+void CanvasWidget::repositionStatsText()
+{
+    assert(mStatsText != nullptr);
+    mStatsText->move(width() - mStatsText->width() - kTextPaddingLeft, kTextPaddingTop + kToolbarHeight);
+}
+
 void CanvasWidget::resetOffsets()
 {
+    mViewAnimation.stop();
+    mPendingZoomSteps = 0;
     mOffset = { 0, 0 };
 }
 
+QRect CanvasWidget::visibleFrameRegion(const QTransform& transform, const QRect& imageRect, const QSizeF& targetSize) const
+{
+    // Pixmap keeps the source orientation, transform maps it centered at zero to the widget
+    const QSizeF frameSize(mImage->width(), mImage->height());
+    const qreal scaleX = targetSize.width() / frameSize.width();
+    const qreal scaleY = targetSize.height() / frameSize.height();
+    const QRectF visible = transform.inverted().mapRect(QRectF(imageRect.intersected(rect())));
+    return QRectF(visible.left() / scaleX + 0.5 * frameSize.width(), visible.top() / scaleY + 0.5 * frameSize.height(),
+        visible.width() / scaleX, visible.height() / scaleY).toAlignedRect().intersected(QRect(QPoint(0, 0), frameSize.toSize()));
+}
+
+QRectF CanvasWidget::frameRegionToLocal(const QRect& region, const QSizeF& targetSize) const
+{
+    const QSizeF frameSize(mImage->width(), mImage->height());
+    const qreal scaleX = targetSize.width() / frameSize.width();
+    const qreal scaleY = targetSize.height() / frameSize.height();
+    return QRectF((region.left() - 0.5 * frameSize.width()) * scaleX, (region.top() - 0.5 * frameSize.height()) * scaleY, region.width() * scaleX, region.height() * scaleY);
+}
+
+void CanvasWidget::drawPreview(QPainter& painter, const QRect& imageRect, const QSizeF& targetSize)
+{
+    const QRect region = visibleFrameRegion(painter.transform(), imageRect, targetSize);
+    if (region.isEmpty()) {
+        return;
+    }
+    // Screen resolution of the region, limited to keep the preview interactive
+    QSizeF proxySize = frameRegionToLocal(region, targetSize).size();
+    const qreal pixels = proxySize.width() * proxySize.height();
+    if (pixels > kPreviewMaxPixels) {
+        proxySize *= std::sqrt(kPreviewMaxPixels / pixels);
+    }
+    const QPixmap preview = mImageProcessor->getPreviewPixmap(region, QSize(std::max(1, qRound(proxySize.width())), std::max(1, qRound(proxySize.height()))));
+    if (!preview.isNull()) {
+        painter.drawPixmap(frameRegionToLocal(mImageProcessor->previewRegion(), targetSize), preview, QRectF(preview.rect()));
+        return;
+    }
+    const QPixmap& last = mImageProcessor->getLastResultPixmap();
+    if (!last.isNull()) {
+        painter.drawPixmap(frameRegionToLocal(mImageProcessor->resultRegion(), targetSize), last, QRectF(last.rect()));
+    }
+}
+
+void CanvasWidget::updateViewport(const QTransform& transform, const QRect& imageRect, const QSizeF& targetSize)
+{
+    const QSize frameSize(mImage->width(), mImage->height());
+    if (static_cast<qreal>(frameSize.width()) * frameSize.height() <= kViewportMinPixels) {
+        // Whole frame is processed once, then zoom and pan are free
+        mImageProcessor->setViewport(QRect(), QSize());
+        return;
+    }
+    const QRect visible = visibleFrameRegion(transform, imageRect, targetSize);
+    if (visible.isEmpty()) {
+        return;
+    }
+    // Only downscaling, magnification is left to the painter
+    const qreal scale = std::min(1.0, targetSize.width() / frameSize.width());
+    const auto scaledSize = [scale](const QRect& r) {
+        return QSize(std::max(1, qRound(r.width() * scale)), std::max(1, qRound(r.height() * scale)));
+    };
+    const QRect current = mImageProcessor->viewport();
+    if (!current.isEmpty() && current.contains(visible) && mImageProcessor->viewportSize() == scaledSize(current)) {
+        return;
+    }
+    // Margin around the visible part makes small pans free
+    const QRect region = visible.adjusted(-visible.width() / 4, -visible.height() / 4, visible.width() / 4, visible.height() / 4).intersected(QRect(QPoint(0, 0), frameSize));
+    mImageProcessor->setViewport(region, scaledSize(region));
+}
+
+void CanvasWidget::updateCanvasBackend()
+{
+    const bool useOpenGL = mSettings->value(Settings::kParamOpenGLCanvasKey, Settings::kParamOpenGLCanvasDefault).toBool();
+    if (useOpenGL && !mGLCanvas) {
+        mGLCanvas = new GLCanvas(this);
+        mGLCanvas->setGeometry(rect());
+        mGLCanvas->lower();
+        // Context is created when the canvas is shown for the first time, then the frame can be uploaded
+        connect(mGLCanvas, &QOpenGLWidget::frameSwapped, this, &CanvasWidget::updateImage, Qt::SingleShotConnection);
+        connect(mGLCanvas, &QOpenGLWidget::frameSwapped, this, &CanvasWidget::onFrameSwapped);
+        mGLCanvas->show();
+    }
+    else if (!useOpenGL && mGLCanvas) {
+        delete mGLCanvas;
+        mGLCanvas = nullptr;
+        updateImage();
+    }
+}
+
+bool CanvasWidget::drawOpenGL(const QRect& imageRect, const QSizeF& targetSize, const QTransform& transform)
+{
+    if (!mGLCanvas->isValid()) {
+        // Not initialized yet, shows the background until the first frame is swapped
+        return true;
+    }
+    const bool smooth = (mFilteringMode == FilteringMode::eAntialiasing);
+    mGLCanvas->setBackground(palette().color(QPalette::ColorRole::Window), mShowTransparencyCheckboard);
+
+    // Unprocessed frame is uploaded once per source frame, processing is done by the shader
+    FIBITMAP* frame = mImageProcessor->getSourceBitmap();
+    if (frame && GLCanvas::isSupported(frame)) {
+        const auto imgType = FreeImage_GetImageType(frame);
+        const bool hdr = (imgType == FIT_FLOAT || imgType == FIT_RGBF || imgType == FIT_RGBAF || FreeImageExt_IsHalf(frame));
+        const FREE_IMAGE_TMO mode = mImageProcessor->toneMappingMode();
+        if (!hdr || mode == FITMO_CLAMP || mode == FITMO_LINEAR) {
+            GLCanvas::Processing processing;
+            processing.gamma = mImageProcessor->getGamma();
+            processing.swizzle = mImageProcessor->getChannelSwizzle();
+            if (hdr && mode == FITMO_LINEAR) {
+                if (mLinearRangeGeneration != mImageProcessor->sourceGeneration()) {
+                    if (!ToneMapping::linearRange(frame, &mLinearRangeLow, &mLinearRangeHigh)) {
+                        mLinearRangeLow  = 0.0f;
+                        mLinearRangeHigh = 1.0f;
+                    }
+                    mLinearRangeGeneration = mImageProcessor->sourceGeneration();
+                }
+                processing.low  = mLinearRangeLow;
+                processing.high = mLinearRangeHigh;
+            }
+            if (mGLCanvas->setFrame(mImageProcessor->sourceGeneration(), frame)) {
+                const QRect frameRect(0, 0, static_cast<int>(FreeImage_GetWidth(frame)), static_cast<int>(FreeImage_GetHeight(frame)));
+                mGLCanvas->setProcessing(processing);
+                mGLCanvas->setView(frameRegionToLocal(frameRect, targetSize), transform, smooth);
+                return true;
+            }
+        }
+    }
+
+    // Other tone mapping operators are applied on CPU, the processed pixmap is uploaded
+    if (mToneMappingPreview || mKeepPreview) {
+        return false;
+    }
+    if (!mViewAnimation.isZooming()) {
+        updateViewport(transform, imageRect, targetSize);
+    }
+    const QPixmap& pixmap = mImageProcessor->getResultPixmap();
+    if (pixmap.isNull() || !mGLCanvas->setPixmap(pixmap)) {
+        return false;
+    }
+    mGLCanvas->setProcessing(GLCanvas::Processing{});
+    mGLCanvas->setView(frameRegionToLocal(mImageProcessor->resultRegion(), targetSize), transform, smooth);
+    return true;
+}
+
 void CanvasWidget::paintEvent(QPaintEvent * event)
 {
     if(mStartup){
@@ -845,6 +1204,8 @@ void CanvasWidget::paintEvent(QPaintEvent * event)
 #endif
     }
 
+    const auto paintStart = std::chrono::steady_clock::now();
+
     QWidget::paintEvent(event);
 
     if (mLocalSettingsAreInvalidated) {
@@ -866,6 +1227,9 @@ void CanvasWidget::paintEvent(QPaintEvent * event)
             if (mPageText) {
                 mPageText->setColor(textColor);
             }
+            if (mStatsText) {
+                mStatsText->setColor(textColor);
+            }
             if (mCloseButton) {
                 mCloseButton->setColor(textColor);
             }
@@ -896,29 +1260,109 @@ void CanvasWidget::paintEvent(QPaintEvent * event)
 
         // Try to render
         try {
+            // Moving frames are drawn from the cached levels, the high quality frame is drawn when the motion stops
+            const bool moving = isViewMoving();
             QPainter painter(this);
-            if (mFilteringMode == FilteringMode::eAntialiasing) {
+            if (mFilteringMode == FilteringMode::eAntialiasing && !(moving && mMotionOverBudget)) {
                 painter.setRenderHint(QPainter::RenderHint::SmoothPixmapTransform, true);
             }
 
-            const auto imageRect = calculateImageRegion();
+            const auto imageRect = displayedImageRegion();
             const auto dstCenter = QRectF(imageRect).center();
 
-            // Make vertical flip
-            const auto trans1 = QTransform::fromTranslate(-dstCenter.x(), -dstCenter.y());
-            const auto scale  = QTransform::fromScale(1.0, -1.0);
-            const auto trans2 = QTransform::fromTranslate(dstCenter.x(), dstCenter.y());
-            painter.setTransform(trans1 * scale * trans2);
+            // Overlays are child widgets, their updates expose only the region under them
+            if (event->region().intersects(imageRect)) {
+                // Rotation and flips are applied here, the pixmap keeps the source orientation
+                const bool transposed = (mImageProcessor->rotation() == Rotation::eDegree90 || mImageProcessor->rotation() == Rotation::eDegree270);
+                const QSizeF pixmapSize = transposed ? QSizeF(imageRect.height(), imageRect.width()) : QSizeF(imageRect.size());
+                const QTransform transform = mImageProcessor->viewTransform() * QTransform::fromTranslate(dstCenter.x(), dstCenter.y());
+
+                const bool drawnByOpenGL = mGLCanvas && drawOpenGL(imageRect, pixmapSize, transform);
+                if (mGLCanvas && mGLCanvas->isHidden() == drawnByOpenGL) {
+                    mGLCanvas->setVisible(drawnByOpenGL);
+                }
 
-            if (mShowTransparencyCheckboard) {
-                painter.drawTiledPixmap(imageRect, mCheckboard.get());
+                if (!drawnByOpenGL) {
+                    // Tiles are composited over the checkerboard, other paths draw it under the image
+                    const auto drawCheckerboard = [&]() {
+                        if (mShowTransparencyCheckboard) {
+                            painter.resetTransform();
+                            painter.drawTiledPixmap(imageRect, mCheckboard.get());
+                        }
+                        painter.setTransform(transform);
+                    };
+                    if (mToneMappingPreview) {
+                        drawCheckerboard();
+                        drawPreview(painter, imageRect, pixmapSize);
+                    }
+                    else {
+                        // Intermediate zoom levels scale the current result, the viewport follows the final one
+                        if (!mViewAnimation.isZooming()) {
+                            updateViewport(transform, imageRect, pixmapSize);
+                        }
+                        // Doesn't block, the last completed result is drawn until the new one is ready
+                        const auto& pixmap = mImageProcessor->getResultPixmap();
+                        if (mImageProcessor->isResultPending() && (mKeepPreview || pixmap.isNull())) {
+                            drawCheckerboard();
+                            // Nothing stands in for the first result of a frame, only the background is drawn until it arrives
+                            if (mKeepPreview) {
+                                drawPreview(painter, imageRect, pixmapSize);
+                            }
+                        }
+                        else {
+                            mKeepPreview = mKeepPreview && mImageProcessor->isResultPending();
+                            const QRectF target = frameRegionToLocal(mImageProcessor->resultRegion(), pixmapSize);
+                            const bool smooth = (mFilteringMode == FilteringMode::eAntialiasing);
+                            // Zoomed out frame is resampled to the screen size in background, meanwhile the closest mip level is drawn
+                            const QSize deviceSize(qRound(target.width() * devicePixelRatioF()), qRound(target.height() * devicePixelRatioF()));
+                            const QPixmap source = (smooth && !pixmap.isNull()) ? mImageProcessor->getResultPixmap(deviceSize, !moving) : pixmap;
+                            // Animation frames and moving views are not reused, so tiles of them are not worth rendering
+                            if (!source.isNull() && !mImageProcessor->isResultPending() && !mEnableAnimation && !moving) {
+                                const qreal ratio = devicePixelRatioF();
+                                TileCache::Scene scene;
+                                scene.sourceKey = source.cacheKey();
+                                scene.transform = QTransform::fromScale(target.width() / source.width(), target.height() / source.height()) * QTransform::fromTranslate(target.x(), target.y())
+                                    * mImageProcessor->viewTransform() * QTransform::fromTranslate(0.5 * imageRect.width(), 0.5 * imageRect.height()) * QTransform::fromScale(ratio, ratio);
+                                scene.size = QRectF(QPointF(0.0, 0.0), QSizeF(imageRect.size()) * ratio).toAlignedRect().size();
+                                scene.devicePixelRatio = ratio;
+                                scene.smooth = smooth;
+                                scene.background = palette().color(QPalette::ColorRole::Window);
+                                scene.checkerboard = mShowTransparencyCheckboard;
+                                painter.resetTransform();
+                                const QRegion missing = mTileCache->draw(painter, imageRect.topLeft(), event->rect(), scene, source);
+                                if (!missing.isEmpty()) {
+                                    // Tiles are rendered in background, meanwhile the exposed part is drawn directly
+                                    painter.save();
+                                    painter.setClipRegion(missing);
+                                    drawCheckerboard();
+                                    painter.drawPixmap(target, source, QRectF(source.rect()));
+                                    painter.restore();
+                                }
+                            }
+                            else {
+                                drawCheckerboard();
+                                painter.drawPixmap(target, source, QRectF(source.rect()));
+                            }
+                        }
+                    }
+                    painter.resetTransform();
+                }
             }
-            painter.drawPixmap(imageRect, mImageProcessor->getResultPixmap());
 
             if (mEnableAnimation && currIndex != mAnimIndex) {
                 new UniqueTick(mImage->id(), mImage->currentPage().animation().duration, this, &CanvasWidget::onAnimationTick, this);
             }
 
+            if (currIndex != mAnimIndex) {
+                const auto now = std::chrono::steady_clock::now();
+                if (mEnableAnimation && mAnimIndex != kNoneIndex) {
+                    mPerformanceStats->addFrameInterval(std::chrono::duration<double, std::milli>(now - mFrameShownTime).count());
+                }
+                mFrameShownTime = now;
+            }
+            mPerformanceStats->setNominalFrameDuration(mEnableAnimation ? mImage->currentPage().animation().duration : 0);
+            mPerformanceStats->setProcessingTime(mImageProcessor->processingTime());
+
             mAnimIndex = currIndex;
             success = true;
         }
@@ -929,24 +1373,31 @@ void CanvasWidget::paintEvent(QPaintEvent * event)
         }
     } // if Image
 
-    if (mShowInfo) {
-        if (!mInfoIsValid) {
-            if (mInfoText && mImageDescription) {
-                mInfoText->setText(mImageDescription->toLines(mDisplayFullPath));
-            }
-            mInfoIsValid = true;
-        }
-        mInfoText->show();
-        if (mImage && mImage->notNull() && (mImage->pagesCount() > 1)) {
-            mPageText->show();
+    updateOverlays();
+
+    if (mGLCanvas && !success) {
+        mGLCanvas->hide();
+    }
+    if (success) {
+        double paintTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - paintStart).count();
+        if (mGLCanvas && mGLCanvas->isVisible()) {
+            // The OpenGL canvas is painted after this widget, the previous frame is accounted
+            mGLCanvas->setMeasureTime(mShowStats);
+            paintTime += mGLCanvas->paintTime();
         }
-        else {
-            mPageText->hide();
+        mPerformanceStats->addPaintTime(paintTime);
+        if (isViewMoving()) {
+            mMotionOverBudget = (paintTime > kMotionFrameBudget * frameInterval());
         }
     }
+    if (mShowStats && success) {
+        mPerformanceStats->setPlaybackStats(mImage->playbackStats());
+        mStatsText->setText(mPerformanceStats->toLines());
+        repositionStatsText();
+        mStatsText->show();
+    }
     else {
-        mInfoText->hide();
-        mPageText->hide();
+        mStatsText->hide();
     }
 
     if (!success) {
@@ -1004,6 +1455,9 @@ void CanvasWidget::recalculateFittingScale()
 void CanvasWidget::resizeEvent(QResizeEvent * event)
 {
     QWidget::resizeEvent(event);
+    if (mGLCanvas) {
+        mGLCanvas->setGeometry(rect());
+    }
     if (mImage && !mImage->isNull()) {
         updateOffsets();
         recalculateFittingScale();
@@ -1027,6 +1481,11 @@ void CanvasWidget::keyPressEvent(QKeyEvent* event)
 
     case ControlAction::eOverlay:
         mShowInfo = !mShowInfo;
+        updateOverlays();
+        break;
+
+    case ControlAction::eStatistics:
+        mShowStats = !mShowStats;
         update();
         break;
 
@@ -1092,7 +1551,7 @@ void CanvasWidget::keyPressEvent(QKeyEvent* event)
                 QString error;
                 try {
                     if (QClipboard* clipboard = QApplication::clipboard()) {
-                        clipboard->setPixmap(mImageProcessor->getResultPixmap().transformed(QTransform::fromScale(1.0, -1.0)));
+                        clipboard->setImage(mImageProcessor->getResultImage());
                     }
                     else {
                         throw std::runtime_error("Clipboard is not available.");
@@ -1136,6 +1595,7 @@ void CanvasWidget::keyPressEvent(QKeyEvent* event)
         if (!mTooltip) {
             mTooltip = std::make_unique<Tooltip>();
             mTooltip->hide();
+            mTooltipIsValid = false;
             invalidateTooltip();
         }
         else {
@@ -1144,11 +1604,11 @@ void CanvasWidget::keyPressEvent(QKeyEvent* event)
         break;
 
     case ControlAction::eZoomIn:
-        zoomToTarget(QPoint(width() / 2, height() / 2), 1);
+        requestZoom(QPoint(width() / 2, height() / 2), 1);
         break;
 
     case ControlAction::eZoomOut:
-        zoomToTarget(QPoint(width() / 2, height() / 2), -1);
+        requestZoom(QPoint(width() / 2, height() / 2), -1);
         break;
 
     case ControlAction::ePreviousImage:
@@ -1187,7 +1647,7 @@ void CanvasWidget::keyPressEvent(QKeyEvent* event)
             else {
                 mEnableAnimation = true;
                 mAnimIndex = kNoneIndex;
-                update();
+                updateImage();
             }
         }
         break;
@@ -1195,8 +1655,9 @@ void CanvasWidget::keyPressEvent(QKeyEvent* event)
     case ControlAction::ePreviousFrame:
         if (mImage && mImage->notNull() && mImage->pagesCount() > 1 && !mEnableAnimation) {
             try {
+                const QRect previousRegion = mZoomController ? displayedImageRegion() : QRect();
                 mImage->next();
-                update();
+                updatePageImage(previousRegion);
             }
             catch(...)
             { }
@@ -1206,8 +1667,9 @@ void CanvasWidget::keyPressEvent(QKeyEvent* event)
     case ControlAction::eNextFrame:
         if (mImage && mImage->notNull() && mImage->pagesCount() > 1 && !mEnableAnimation) {
             try {
+                const QRect previousRegion = mZoomController ? displayedImageRegion() : QRect();
                 mImage->prev();
-                update();
+                updatePageImage(previousRegion);
             }
             catch(...)
             { }
@@ -1216,8 +1678,7 @@ void CanvasWidget::keyPressEvent(QKeyEvent* event)
 
     case ControlAction::eDisplayPath:
         mDisplayFullPath = !mDisplayFullPath;
-        mInfoIsValid = false;
-        update();
+        invalidateImageDescription();
         break;
 
     case ControlAction::eHistogram:
@@ -1316,6 +1777,8 @@ void CanvasWidget::mousePressEvent(QMouseEvent* event)
         mBrowsing = true;
         mClickPos = event->pos();
         mMenuPos  = event->pos();
+        mViewAnimation.stop();
+        mViewAnimation.trackPan(event->pos(), ViewAnimation::Clock::now());
     }
     mClick = true;
 }
@@ -1334,6 +1797,17 @@ void CanvasWidget::mouseReleaseEvent(QMouseEvent* event)
     if (mBrowsing && mMenuPos == event->pos()) {
         emit customContextMenuRequested(mMenuPos);
     }
+    else if (mBrowsing) {
+        mBrowsing = false;
+        if (mViewAnimation.startPan(ViewAnimation::Clock::now())) {
+            startFrameLoop();
+        }
+        else {
+            // Drag frames were drawn from the cached levels
+            mMotionOverBudget = false;
+            updateImage();
+        }
+    }
     mBrowsing = false;
     mClick = false;
 }
@@ -1382,6 +1856,7 @@ void CanvasWidget::applicationStateChanged(Qt::ApplicationState state)
             invalidateTooltip();
         }
         else {
+            mTooltipTimer->stop();
             mTooltip->hide();
         }
     }
@@ -1403,8 +1878,10 @@ void CanvasWidget::mouseMoveEvent(QMouseEvent* event)
         else if (mBrowsing) {
             mOffset += event->pos() - mClickPos;
             mClickPos = event->pos();
+            mViewAnimation.trackPan(event->pos(), ViewAnimation::Clock::now());
             updateOffsets();
-            repaint();
+            // Moves are coalesced into one paint per frame
+            update();
         }
         else if (!mFullScreen && !mTooltip) {
             if (!(event->buttons() & Qt::LeftButton)) {
@@ -1481,6 +1958,7 @@ void CanvasWidget::onHoverInterruted()
         unsetCursor();
     }
     if (mTooltip) {
+        mTooltipTimer->stop();
         mTooltip->hide();
     }
 }
@@ -1488,26 +1966,56 @@ void CanvasWidget::onHoverInterruted()
 void CanvasWidget::leaveEvent(QEvent* event)
 {
     if (mTooltip) {
+        mTooltipTimer->stop();
         mTooltip->hide();
     }
 }
 
 void CanvasWidget::invalidateTooltip()
+{
+    if (mTooltip && !mTooltipTimer->isActive()) {
+        mTooltipTimer->start(frameInterval());
+    }
+}
+
+void CanvasWidget::updateTooltip()
 {
     if (mTooltip) {
-        const auto imageRect = calculateImageRegion();
-        if (mImageProcessor && imageRect.contains(mCursorPosition)) {
+        const bool hasImage = mImage && !mImage->isNull() && mImageProcessor && mZoomController;
+        const auto imageRect = hasImage ? calculateImageRegion() : QRect();
+        if (hasImage && imageRect.contains(mCursorPosition)) {
             unsetCursor();
 
             QPoint imgPos = mCursorPosition - imageRect.topLeft();
             const uint32_t px = static_cast<uint32_t>(mImage->width()  * imgPos.x() / static_cast<float>(imageRect.width()));
             const uint32_t py = static_cast<uint32_t>(mImage->height() * imgPos.y() / static_cast<float>(imageRect.height()));
 
-            Pixel pixelValue{};
-            if (mImageProcessor->getPixel(py, px, &pixelValue)) {
+            const QPoint pixel(static_cast<int>(px), static_cast<int>(py));
+            const uint64_t generation = mImageProcessor->sourceGeneration();
+            const QTransform orientation = mImageProcessor->viewTransform();
+            const bool changed = !mTooltipIsValid || mTooltipPixel != pixel || mTooltipGeneration != generation || mTooltipOrientation != orientation;
+            if (changed) {
+                mTooltipIsValid = true;
+                mTooltipPixel = pixel;
+                mTooltipGeneration = generation;
+                mTooltipOrientation = orientation;
+
+                Pixel pixelValue{};
+                mTooltipHasValue = mImageProcessor->getPixel(py, px, &pixelValue);
+                if (mTooltipHasValue) {
+                    char coordinates[32];
+                    const int length = std::snprintf(coordinates, sizeof(coordinates), "Y: %u, X: %u", pixelValue.y, pixelValue.x);
+                    mTooltipLines.resize(2);
+                    mTooltipLines[0] = QString::fromLatin1(coordinates, std::clamp(length, 0, static_cast<int>(sizeof(coordinates)) - 1));
+                    mTooltipLines[1] = std::move(pixelValue.repr);
+                    mTooltip->setText(mTooltipLines);
+                }
+            }
+            if (mTooltipHasValue) {
                 mTooltip->move(mapToGlobal(mCursorPosition));
-                mTooltip->setText({ QString("Y: %1, X: %2").arg(pixelValue.y).arg(pixelValue.x), pixelValue.repr });
-                mTooltip->show();
+                if (changed || !mTooltip->isVisible()) {
+                    mTooltip->show();
+                }
             }
             else {
                 mTooltip->hide();
@@ -1531,17 +2039,31 @@ void CanvasWidget::invalidateExif()
     }
 }
 
-void CanvasWidget::zoomToTarget(QPoint target, int dir)
+void CanvasWidget::requestZoom(QPoint target, int steps)
+{
+    // Bursts of wheel and key events are rendered once per frame, the intermediate frames are animated from the cached levels
+    mPendingZoomSteps += steps;
+    mPendingZoomTarget = target;
+    startFrameLoop();
+}
+
+void CanvasWidget::zoomToTarget(QPoint target, int steps)
 {
     if(mZoomController && mImage && !mImage->isNull()) {
 
+        // Transition starts from the displayed state, so that fast steps continue the current one
+        const QRectF zoomFrom = QRectF(displayedImageRegion());
+        mViewAnimation.stopPan();
+
         const int w = mZoomController->getValue();
 
-        if (dir > 0) {
-            mZoomController->zoomPlus();
-        }
-        else { 
-            mZoomController->zoomMinus();
+        for (int i = 0; i < std::abs(steps); ++i) {
+            if (steps > 0) {
+                mZoomController->zoomPlus();
+            }
+            else {
+                mZoomController->zoomMinus();
+            }
         }
 
         const int dw = mZoomController->getValue();
@@ -1559,6 +2081,10 @@ void CanvasWidget::zoomToTarget(QPoint target, int dir)
 
         updateOffsets();
         updateZoomLabel();
+        mViewAnimation.startZoom(zoomFrom, QRectF(calculateImageRegion()), ViewAnimation::Clock::now());
+        if (mViewAnimation.isActive()) {
+            startFrameLoop();
+        }
         update();
     }
 }
@@ -1570,7 +2096,7 @@ void CanvasWidget::wheelEvent(QWheelEvent* event)
         if (!degrees.isNull() && degrees.y() != 0) {
             const int dir = 2 * static_cast<int>(mSettings->value(Settings::kParamInvertZoom, Settings::kParamShowCloseButtonDefault).toBool()) - 1;   // 0,1 -> -1,1
             mCursorPosition = event->position().toPoint();
-            zoomToTarget(mCursorPosition, (degrees.y() > 0) ? -dir : dir);
+            requestZoom(mCursorPosition, (degrees.y() > 0) ? -dir : dir);
             invalidateTooltip();
         }
     }
@@ -1582,7 +2108,7 @@ void CanvasWidget::onActNoFilter(bool checked)
 {
     if (checked) {
         mFilteringMode = FilteringMode::eNone;
-        update();
+        updateImage();
     }
 }
 
@@ -1590,7 +2116,7 @@ void CanvasWidget::onActAntialiasing(bool checked)
 {
     if (checked) {
         mFilteringMode = FilteringMode::eAntialiasing;
-        update();
+        updateImage();
     }
 }
 
@@ -1633,7 +2159,7 @@ void CanvasWidget::onActFlip(bool checked, FlipType f)
 {
     if (mImageProcessor) {
         mImageProcessor->setFlip(f, checked);
-        update();
+        updateImage();
     }
 }
 
@@ -1643,6 +2169,7 @@ void CanvasWidget::onActZoomMode(bool checked, ZoomMode z)
         mZoomMode = z;
         switch(mZoomMode) {
         case ZoomMode::eIdentity:
+            mViewAnimation.stop();
             mZoomController->moveToIdentity();
             updateZoomLabel();
             updateOffsets();
@@ -1650,6 +2177,7 @@ void CanvasWidget::onActZoomMode(bool checked, ZoomMode z)
             break;
 
         case ZoomMode::eFitWindow:
+            mViewAnimation.stop();
             mZoomController->moveToFit();
             updateZoomLabel();
             updateOffsets();
@@ -1684,7 +2212,7 @@ void CanvasWidget::onAnimationTick(uint64_t imgId)
         catch(...) {
             // ToDo (a.gruzdev): Report error here
         }
-        update();
+        updateImage();
     }
 }
 
@@ -1695,11 +2223,37 @@ void CanvasWidget::onActToneMapping(bool checked, FREE_IMAGE_TMO m)
         if (mImageDescription) {
             mImageDescription->setToneMapping(m);
         }
+        updateToneMappingSliders();
         invalidateImageDescription();
-        update();
+        updateImage();
     }
 }
 
+void CanvasWidget::onToneMappingSliderPressed()
+{
+    mToneMappingPreview = true;
+}
+
+void CanvasWidget::onToneMappingSliderMoved()
+{
+    const auto params = ToneMapping::parameters(mImageProcessor->toneMappingMode());
+    std::array<double, 2> values = { 0.0, 0.0 };
+    for (size_t i = 0; i < params.size() && i < values.size(); ++i) {
+        values[i] = mToneMappingSliders[i]->value();
+    }
+    mImageProcessor->setToneMappingParams(values[0], values[1]);
+    updateImage();
+}
+
+void CanvasWidget::onToneMappingSliderReleased()
+{
+    onToneMappingSliderMoved();
+    mToneMappingPreview = false;
+    // Preview stays on screen until the full resolution result is ready
+    mKeepPreview = true;
+    updateImage();
+}
+
 void CanvasWidget::onActGammaType(bool checked, GammaType g)
 {
     if (checked) {
@@ -1723,7 +2277,7 @@ void CanvasWidget::onActGammaType(bool checked, GammaType g)
             mImageDescription->setGammaValue(value);
             invalidateImageDescription();
         }
-        update();
+        updateImage();
     }
 }
 
@@ -1731,7 +2285,7 @@ void CanvasWidget::onActSwizzle(bool checked, ChannelSwizzle s)
 {
     if (checked && mImageProcessor) {
         mImageProcessor->setChannelSwizzle(s);
-        update();
+        updateImage();
     }
 }
 
@@ -1739,12 +2293,13 @@ void CanvasWidget::onActTransparency(bool checked)
 {
     if (mShowTransparencyCheckboard != checked) {
         mShowTransparencyCheckboard = checked;
-        update();
+        updateImage();
     }
 }
 
 void CanvasWidget::onSettingsChanged()
 {
     mLocalSettingsAreInvalidated = true;
+    updateCanvasBackend();
     update();
 }
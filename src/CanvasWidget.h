@@ -37,15 +37,20 @@
 #include "ImageProcessor.h"
 #include "EnumArray.h"
 #include "ImageDescription.h"
+#include "PerformanceStats.h"
+#include "ViewAnimation.h"
 
 enum class BorderPosition;
 
 class AboutWidget;
 class Controls;
 class HistogramWidget;
+class MenuSliderWidget;
 class ExifWidget;
+class GLCanvas;
 class SettingsWidget;
 class TextWidget;
+class TileCache;
 class ToolbarButton;
 class Tooltip;
 class ZoomController;
@@ -116,6 +121,9 @@ public slots:
     void onActGammaType(bool checked, GammaType g);
     void onActSwizzle(bool checked, ChannelSwizzle s);
     void onActTransparency(bool checked);
+    void onToneMappingSliderPressed();
+    void onToneMappingSliderMoved();
+    void onToneMappingSliderReleased();
 
     void onShowContextMenu(const QPoint &pos);
 
@@ -153,9 +161,48 @@ private:
     void closeEvent(QCloseEvent* event) Q_DECL_OVERRIDE;
 
     void invalidateImageDescription();
+
+    /**
+     * Shows or hides the text overlays, they are child widgets and don't need repaint of the image
+     */
+    void updateOverlays();
+
+    /**
+     * Schedules repaint of the image region only
+     */
+    void updateImage();
+
+    /**
+     * Schedules repaint of both the image region and the region drawn before, which may be larger for other pages
+     */
+    void updatePageImage(const QRect& previousRegion);
+
     void updateZoomLabel();
 
     QRect calculateImageRegion() const;
+
+    /**
+     * Image region on the screen, differs from calculateImageRegion() during zoom transitions
+     */
+    QRect displayedImageRegion() const;
+
+    /**
+     * True during animations and drags, when frames are drawn from the cached levels only
+     */
+    bool isViewMoving() const;
+
+    /**
+     * Starts repaints at the display refresh rate until the view animation is over.
+     * With the OpenGL canvas frames follow its buffer swaps, which are synchronized with the display.
+     * Raster frames are flushed without a vertical blank signal on most platforms, so a precise timer at the refresh interval ticks instead.
+     */
+    void startFrameLoop();
+
+    bool isPacedBySwaps() const;
+
+    void onFrameSwapped();
+
+    void onFrameTick();
     void setGeometry2(QRect r);
 
     void resetOffsets();
@@ -167,10 +214,20 @@ private:
 
     bool setFullscreenGeometry();
 
-    void zoomToTarget(QPoint target, int dir);
+    /**
+     * Zooms by the number of steps keeping the target point in place, negative steps zoom out
+     */
+    void zoomToTarget(QPoint target, int steps);
+
+    /**
+     * Accumulates zoom steps, which are applied once in the next frame
+     */
+    void requestZoom(QPoint target, int steps);
 
     void repositionPageText();
 
+    void repositionStatsText();
+
     QWidgetAction* createMenuAction(const QString & text);
 
     ActionsArray<Rotation> initRotationActions();
@@ -182,8 +239,52 @@ private:
 
     QMenu* createContextMenu();
 
+    void updateToneMappingSliders();
+
+    /**
+     * Visible part of the frame in pixmap coordinates
+     */
+    QRect visibleFrameRegion(const QTransform& transform, const QRect& imageRect, const QSizeF& targetSize) const;
+
+    /**
+     * Maps region of the frame to the painter coordinates, where the frame is centered at zero
+     */
+    QRectF frameRegionToLocal(const QRect& region, const QSizeF& targetSize) const;
+
+    /**
+     * Switches large frames to processing of the visible region only
+     */
+    void updateViewport(const QTransform& transform, const QRect& imageRect, const QSizeF& targetSize);
+
+    /**
+     * Draws downsampled visible part of the frame, while the full result is not available.
+     * Until the preview is built in background, the last completed result stands in for it.
+     */
+    void drawPreview(QPainter& painter, const QRect& imageRect, const QSizeF& targetSize);
+
+    /**
+     * Creates or removes the OpenGL canvas according to the settings
+     */
+    void updateCanvasBackend();
+
+    /**
+     * Passes the frame and the view to the OpenGL canvas.
+     * Returns false if the frame must be drawn by the raster path.
+     */
+    bool drawOpenGL(const QRect& imageRect, const QSizeF& targetSize, const QTransform& transform);
+
+    /**
+     * Schedules update of the tooltip, updates are coalesced to the refresh rate
+     */
     void invalidateTooltip();
 
+    void updateTooltip();
+
+    /**
+     * Refresh interval of the screen in milliseconds
+     */
+    int frameInterval() const;
+
     void invalidateExif();
 
 private:
@@ -195,7 +296,19 @@ private:
     std::unique_ptr<ImageDescription> mImageDescription;
     bool mDisplayFullPath = false;
 
+    std::unique_ptr<PerformanceStats> mPerformanceStats;
+    bool mShowStats = false;
+    std::chrono::steady_clock::time_point mFrameShownTime;
+
     std::unique_ptr<ImageProcessor> mImageProcessor;
+    std::unique_ptr<TileCache> mTileCache;
+
+    // Optional backend, child widget below the overlays
+    GLCanvas* mGLCanvas = nullptr;
+    // Range of the linear tone mapping applied by the shader
+    uint64_t mLinearRangeGeneration = UINT64_MAX;
+    float mLinearRangeLow  = 0.0f;
+    float mLinearRangeHigh = 1.0f;
 
     bool mTransitionRequested = true;
     bool mTransitionIsReload = false;
@@ -220,6 +333,14 @@ private:
 
     QPoint mOffset{ 0, 0 };
 
+    ViewAnimation mViewAnimation;
+    // Zoom input of the current frame
+    int mPendingZoomSteps = 0;
+    QPoint mPendingZoomTarget;
+    QTimer* mFrameTimer = nullptr;
+    // Smooth filtering is dropped from moving frames, which don't fit into the frame interval
+    bool mMotionOverBudget = false;
+
     std::unique_ptr<ZoomController> mZoomController;
     ZoomMode mZoomMode;
     bool mRememberZoom = false;
@@ -235,7 +356,17 @@ private:
 
     TextWidget* mPageText = nullptr;
 
+    TextWidget* mStatsText = nullptr;
+
     std::unique_ptr<Tooltip> mTooltip;
+    QTimer* mTooltipTimer = nullptr;
+    // Pixel shown by the tooltip, its value is read again only if the pixel or the frame changes
+    bool mTooltipIsValid = false;
+    bool mTooltipHasValue = false;
+    QPoint mTooltipPixel;
+    uint64_t mTooltipGeneration = 0;
+    QTransform mTooltipOrientation;
+    QVector<QString> mTooltipLines;
 
     FilteringMode mFilteringMode;
 
@@ -251,6 +382,12 @@ private:
 
     HistogramWidget* mHistogramWidget = nullptr;
 
+    // Parameters of the current tone mapping operator
+    std::array<QWidgetAction*, 2> mActToneMappingParams{};
+    std::array<MenuSliderWidget*, 2> mToneMappingSliders{};
+    bool mToneMappingPreview = false;
+    bool mKeepPreview = false;
+
     // Actions
     std::shared_future<ActionsArray<Rotation>> mActRotate;
     std::shared_future<ActionsArray<FlipType>> mActFlip;
@@ -77,6 +77,8 @@ QString toQString(ControlAction a)
         return "DisplayPath";
     case ControlAction::eHistogram:
         return "Histogram";
+    case ControlAction::eStatistics:
+        return "Statistics";
     case ControlAction::eSettings:
         return "Settings";
     case ControlAction::eLog:
@@ -159,6 +161,7 @@ Controls::Controls()
     loadKey(ControlAction::eColorPicker, "Color picker mode", Qt::ControlModifier | Qt::Key_I);
     loadKey(ControlAction::eDisplayPath, "Display full path", Qt::ControlModifier | Qt::Key_P);
     loadKey(ControlAction::eHistogram, "Display/hide histogram", Qt::ControlModifier | Qt::Key_H);
+    loadKey(ControlAction::eStatistics, "Display/hide performance statistics", Qt::Key_F3);
     loadKey(ControlAction::eSettings, "Open settings window", Qt::Key_F9);
     loadKey(ControlAction::eLog, "Display/hide log", Qt::Key_F10);
     loadKey(ControlAction::eQuit, "Quit", Qt::Key_Escape);
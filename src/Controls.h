@@ -52,6 +52,7 @@ enum class ControlAction
     eColorPicker,
     eDisplayPath,
     eHistogram,
+    eStatistics,
     eSettings,
     eLog,
     eQuit,
@@ -20,11 +20,33 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <cmath>
 #include <tuple>
+#include "Parallel.h"
 #include "PluginFLO.h"
 #include "PluginSVG.h"
+#include "RowKernels.h"
+
+namespace
+{
+    const char* const kHalfKey = "HalfFloat";
+
+    uint32_t halfChannels(FREE_IMAGE_TYPE type)
+    {
+        switch (type) {
+        case FIT_UINT16:
+            return 1;
+        case FIT_RGB16:
+            return 3;
+        case FIT_RGBA16:
+            return 4;
+        default:
+            return 0;
+        }
+    }
+}
 
 
 
@@ -50,6 +72,16 @@ const char* FreeImageExt_TMtoString(FREE_IMAGE_TMO mode)
 
 const char* FreeImageExt_DescribeImageType(FIBITMAP* dib)
 {
+    if (FreeImageExt_IsHalf(dib)) {
+        switch (FreeImage_GetImageType(dib)) {
+        case FIT_RGBA16:
+            return "RGBA Float16";
+        case FIT_RGB16:
+            return "RGB Float16";
+        default:
+            return "Greyscale Float16";
+        }
+    }
     if (dib) {
         switch (FreeImage_GetImageType(dib)) {
         case FIT_RGBAF:
@@ -135,3 +167,99 @@ const char* FreeImageExt_DescribeImageType(FIBITMAP* dib)
 }
 
 
+bool FreeImageExt_IsHalf(FIBITMAP* dib)
+{
+    if (!dib || !halfChannels(FreeImage_GetImageType(dib))) {
+        return false;
+    }
+    FITAG* tag = nullptr;
+    return FreeImage_GetMetadata(FIMD_CUSTOM, dib, kHalfKey, &tag) && tag;
+}
+
+FIBITMAP* FreeImageExt_ConvertToHalf(FIBITMAP* dib)
+{
+    if (!dib || !FreeImage_HasPixels(dib)) {
+        return nullptr;
+    }
+    FREE_IMAGE_TYPE dstType = FIT_UNKNOWN;
+    switch (FreeImage_GetImageType(dib)) {
+    case FIT_FLOAT:
+        dstType = FIT_UINT16;
+        break;
+    case FIT_RGBF:
+        dstType = FIT_RGB16;
+        break;
+    case FIT_RGBAF:
+        dstType = FIT_RGBA16;
+        break;
+    default:
+        return nullptr;
+    }
+    const uint32_t width  = FreeImage_GetWidth(dib);
+    const uint32_t height = FreeImage_GetHeight(dib);
+    const uint32_t rowSize = width * halfChannels(dstType);
+    UniqueBitmap dst(FreeImage_AllocateT(dstType, width, height), &::FreeImage_Unload);
+    if (!dst) {
+        return nullptr;
+    }
+    std::atomic<bool> exact{ true };
+    parallelFor(height, rowSize, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t y = begin; y < end && exact; ++y) {
+            const auto srcLine = reinterpret_cast<const float*>(FreeImage_GetScanLine(dib, static_cast<int>(y)));
+            const auto dstLine = reinterpret_cast<uint16_t*>(FreeImage_GetScanLine(dst.get(), static_cast<int>(y)));
+            if (!RowKernels::floatToHalf(srcLine, dstLine, rowSize)) {
+                exact = false;
+            }
+        }
+    });
+    if (!exact) {
+        return nullptr;
+    }
+    FreeImage_CloneMetadata(dst.get(), dib);
+    FreeImage_SetDotsPerMeterX(dst.get(), FreeImage_GetDotsPerMeterX(dib));
+    FreeImage_SetDotsPerMeterY(dst.get(), FreeImage_GetDotsPerMeterY(dib));
+    if (FIBITMAP* thumbnail = FreeImage_GetThumbnail(dib)) {
+        FreeImage_SetThumbnail(dst.get(), thumbnail);
+    }
+    if (!FreeImageExt_SetMetadataValue(FIMD_CUSTOM, dst.get(), kHalfKey, uint32_t{ 1 })) {
+        return nullptr;
+    }
+    return dst.release();
+}
+
+FIBITMAP* FreeImageExt_ConvertFromHalf(FIBITMAP* dib, int left, int top, int right, int bottom)
+{
+    if (!FreeImageExt_IsHalf(dib)) {
+        return nullptr;
+    }
+    const int width  = static_cast<int>(FreeImage_GetWidth(dib));
+    const int height = static_cast<int>(FreeImage_GetHeight(dib));
+    if (right <= left || bottom <= top) {
+        left = 0;
+        top = 0;
+        right = width;
+        bottom = height;
+    }
+    if (left < 0 || top < 0 || right > width || bottom > height) {
+        return nullptr;
+    }
+    const FREE_IMAGE_TYPE srcType = FreeImage_GetImageType(dib);
+    const FREE_IMAGE_TYPE dstType = (srcType == FIT_RGBA16) ? FIT_RGBAF : ((srcType == FIT_RGB16) ? FIT_RGBF : FIT_FLOAT);
+    const uint32_t channels = halfChannels(srcType);
+    const uint32_t dstWidth  = static_cast<uint32_t>(right - left);
+    const uint32_t dstHeight = static_cast<uint32_t>(bottom - top);
+    FIBITMAP* dst = FreeImage_AllocateT(dstType, dstWidth, dstHeight);
+    if (!dst) {
+        return nullptr;
+    }
+    // Scanlines are bottom-up
+    const int srcFirstLine = height - bottom;
+    parallelFor(dstHeight, dstWidth * channels, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t y = begin; y < end; ++y) {
+            const auto srcLine = reinterpret_cast<const uint16_t*>(FreeImage_GetScanLine(dib, srcFirstLine + static_cast<int>(y)));
+            const auto dstLine = reinterpret_cast<float*>(FreeImage_GetScanLine(dst, static_cast<int>(y)));
+            RowKernels::halfToFloat(srcLine + channels * left, dstLine, dstWidth * channels);
+        }
+    });
+    return dst;
+}
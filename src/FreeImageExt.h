@@ -131,6 +131,23 @@ FIBITMAP* FreeImageExt_AllocateLike(FIBITMAP* dib)
         FreeImage_GetRedMask(dib), FreeImage_GetGreenMask(dib), FreeImage_GetBlueMask(dib));
 }
 
+/**
+ * Half precision images are stored as FIT_UINT16, FIT_RGB16 or FIT_RGBA16 bitmaps marked by custom metadata
+ */
+bool FreeImageExt_IsHalf(FIBITMAP* dib);
+
+/**
+ * Converts FIT_FLOAT, FIT_RGBF or FIT_RGBAF bitmap to half precision with all metadata.
+ * Returns nullptr if some value is not exactly representable in half precision, so the conversion never loses data.
+ */
+FIBITMAP* FreeImageExt_ConvertToHalf(FIBITMAP* dib);
+
+/**
+ * Expands half precision bitmap to FIT_FLOAT, FIT_RGBF or FIT_RGBAF without metadata.
+ * Optional rectangle is top-down as in FreeImage_Copy, the whole image is converted if it is empty.
+ */
+FIBITMAP* FreeImageExt_ConvertFromHalf(FIBITMAP* dib, int left = 0, int top = 0, int right = 0, int bottom = 0);
+
 
 #endif //__cplusplus
 
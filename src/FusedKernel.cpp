@@ -0,0 +1,559 @@
+/**
+ * @file
+ *
+ * Copyright 2018-2026 Alexey Gruzdev
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FusedKernel.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+#include "Gamma.h"
+#include "Parallel.h"
+#include "PixelTraits.h"
+#include "RowKernels.h"
+
+namespace
+{
+    struct Color8
+    {
+        uint8_t r, g, b, a;
+    };
+
+    inline
+    uint8_t clampToByte(float v)
+    {
+        // Same as FreeImage_TmoClamp. NaN is mapped to zero.
+        const float s = 256.0f * v;
+        return (s > 0.0f) ? ((s < 255.0f) ? static_cast<uint8_t>(s) : 255) : 0;
+    }
+
+
+    template <bool UseGamma_>
+    inline
+    uint8_t toByte(uint8_t v, const Gamma& gamma)
+    {
+        return UseGamma_ ? gamma(v) : v;
+    }
+
+    template <bool UseGamma_>
+    inline
+    uint8_t toByte(float v, const Gamma& gamma)
+    {
+        // Floating point values are corrected before quantization
+        return clampToByte(UseGamma_ ? gamma(v) : v);
+    }
+
+
+    inline
+    uint8_t alphaToByte(uint8_t v)
+    {
+        return v;
+    }
+
+    inline
+    uint8_t alphaToByte(float v)
+    {
+        return clampToByte(v);
+    }
+
+
+    /**
+     * Reads a pixel of any format, alpha is not gamma corrected
+     */
+    template <typename Traits_>
+    struct ReadPixel
+    {
+        template <bool UseGamma_>
+        static Color8 read(const uint8_t* line, int64_t x, const Gamma& gamma)
+        {
+            const uint8_t a = alphaToByte(Traits_::alpha(line, x));
+            if (Traits_::kChannels == 1) {
+                const uint8_t v = toByte<UseGamma_>(Traits_::red(line, x), gamma);
+                return { v, v, v, a };
+            }
+            return { toByte<UseGamma_>(Traits_::red(line, x), gamma), toByte<UseGamma_>(Traits_::green(line, x), gamma), toByte<UseGamma_>(Traits_::blue(line, x), gamma), a };
+        }
+    };
+
+    using ReadGray8  = ReadPixel<PixelTraits<PixelFormat::eGray8>>;
+    using ReadRGB8   = ReadPixel<PixelTraits<PixelFormat::eRGB8>>;
+    using ReadRGBA8  = ReadPixel<PixelTraits<PixelFormat::eRGBA8>>;
+    using ReadGrayH  = ReadPixel<PixelTraits<PixelFormat::eGrayHalf>>;
+    using ReadRGBH   = ReadPixel<PixelTraits<PixelFormat::eRGBHalf>>;
+    using ReadRGBAH  = ReadPixel<PixelTraits<PixelFormat::eRGBAHalf>>;
+    using ReadGrayF  = ReadPixel<PixelTraits<PixelFormat::eGrayFloat>>;
+    using ReadRGBF   = ReadPixel<PixelTraits<PixelFormat::eRGBFloat>>;
+    using ReadRGBAF  = ReadPixel<PixelTraits<PixelFormat::eRGBAFloat>>;
+
+
+    struct WriteGray
+    {
+        ChannelSwizzle channel;
+
+        void write(uint8_t* line, uint32_t x, const Color8& c) const
+        {
+            switch (channel) {
+            case ChannelSwizzle::eGreen:
+                line[x] = c.g;
+                break;
+            case ChannelSwizzle::eBlue:
+                line[x] = c.b;
+                break;
+            case ChannelSwizzle::eAlpha:
+                line[x] = c.a;
+                break;
+            default:
+                line[x] = c.r;
+                break;
+            }
+        }
+    };
+
+    template <bool SwapRB_>
+    struct WriteRGB
+    {
+        void write(uint8_t* line, uint32_t x, const Color8& c) const
+        {
+            auto& p = reinterpret_cast<FIRGB8*>(line)[x];
+            p.red   = SwapRB_ ? c.b : c.r;
+            p.green = c.g;
+            p.blue  = SwapRB_ ? c.r : c.b;
+        }
+    };
+
+    template <bool SwapRB_>
+    struct WriteRGBA
+    {
+        void write(uint8_t* line, uint32_t x, const Color8& c) const
+        {
+            auto& p = reinterpret_cast<FIRGBA8*>(line)[x];
+            p.red   = SwapRB_ ? c.b : c.r;
+            p.green = c.g;
+            p.blue  = SwapRB_ ? c.r : c.b;
+            p.alpha = c.a;
+        }
+    };
+
+
+    /**
+     * Vectorized processing of a contiguous source row, gamma is null if not used.
+     * Returns false if there is no specialized kernel for the combination.
+     */
+    template <typename Reader_, typename Writer_>
+    struct RowKernel
+    {
+        static bool run(const uint8_t* /*line*/, int64_t /*x*/, uint8_t* /*dst*/, uint32_t /*count*/, const Writer_& /*writer*/, const Gamma* /*gamma*/)
+        {
+            return false;
+        }
+    };
+
+    inline
+    float gammaValue(const Gamma* gamma)
+    {
+        return gamma ? static_cast<float>(gamma->value()) : 1.0f;
+    }
+
+    inline
+    uint32_t channelOffset(ChannelSwizzle channel)
+    {
+        switch (channel) {
+        case ChannelSwizzle::eGreen:
+            return offsetof(FIRGBA8, green);
+        case ChannelSwizzle::eBlue:
+            return offsetof(FIRGBA8, blue);
+        case ChannelSwizzle::eAlpha:
+            return offsetof(FIRGBA8, alpha);
+        default:
+            return offsetof(FIRGBA8, red);
+        }
+    }
+
+    /**
+     * Gamma correction of 8 bit channels with the table of Gamma.
+     * Lookups are plain loads: 256 entry lookups built of SSSE3 or AVX2 shuffles were not faster.
+     */
+    inline
+    void lookupChannel(const uint8_t* src, uint32_t pixelSize, uint32_t offset, uint8_t* dst, uint32_t count, const Gamma& gamma)
+    {
+        src += offset;
+        for (uint32_t i = 0; i < count; ++i, src += pixelSize) {
+            dst[i] = gamma(*src);
+        }
+    }
+
+    template <uint32_t PixelSize_, bool SwapRB_>
+    void lookupPixels(const uint8_t* src, uint8_t* dst, uint32_t count, const Gamma& gamma)
+    {
+        for (uint32_t i = 0; i < count; ++i, src += PixelSize_, dst += PixelSize_) {
+            dst[0] = gamma(src[SwapRB_ ? 2 : 0]);
+            dst[1] = gamma(src[1]);
+            dst[2] = gamma(src[SwapRB_ ? 0 : 2]);
+            if (PixelSize_ == 4) {
+                dst[3] = src[3];
+            }
+        }
+    }
+
+    template <>
+    struct RowKernel<ReadGray8, WriteGray>
+    {
+        static bool run(const uint8_t* line, int64_t x, uint8_t* dst, uint32_t count, const WriteGray&, const Gamma* gamma)
+        {
+            if (gamma) {
+                lookupChannel(line + x, 1, 0, dst, count, *gamma);
+            }
+            else {
+                std::memcpy(dst, line + x, count);
+            }
+            return true;
+        }
+    };
+
+    template <>
+    struct RowKernel<ReadRGB8, WriteGray>
+    {
+        static bool run(const uint8_t* line, int64_t x, uint8_t* dst, uint32_t count, const WriteGray& writer, const Gamma* gamma)
+        {
+            if (gamma) {
+                lookupChannel(line + 3 * x, 3, channelOffset(writer.channel), dst, count, *gamma);
+            }
+            else {
+                RowKernels::extractChannel(line + 3 * x, 3, channelOffset(writer.channel), dst, count);
+            }
+            return true;
+        }
+    };
+
+    template <>
+    struct RowKernel<ReadRGBA8, WriteGray>
+    {
+        static bool run(const uint8_t* line, int64_t x, uint8_t* dst, uint32_t count, const WriteGray& writer, const Gamma* gamma)
+        {
+            // Alpha is not gamma corrected
+            if (gamma && writer.channel != ChannelSwizzle::eAlpha) {
+                lookupChannel(line + 4 * x, 4, channelOffset(writer.channel), dst, count, *gamma);
+            }
+            else {
+                RowKernels::extractChannel(line + 4 * x, 4, channelOffset(writer.channel), dst, count);
+            }
+            return true;
+        }
+    };
+
+    template <bool SwapRB_>
+    struct RowKernel<ReadRGB8, WriteRGB<SwapRB_>>
+    {
+        static bool run(const uint8_t* line, int64_t x, uint8_t* dst, uint32_t count, const WriteRGB<SwapRB_>&, const Gamma* gamma)
+        {
+            if (gamma) {
+                lookupPixels<3, SwapRB_>(line + 3 * x, dst, count, *gamma);
+            }
+            else if (SwapRB_) {
+                RowKernels::swapRedBlue24(line + 3 * x, dst, count);
+            }
+            else {
+                std::memcpy(dst, line + 3 * x, 3 * static_cast<size_t>(count));
+            }
+            return true;
+        }
+    };
+
+    template <bool SwapRB_>
+    struct RowKernel<ReadRGBA8, WriteRGBA<SwapRB_>>
+    {
+        static bool run(const uint8_t* line, int64_t x, uint8_t* dst, uint32_t count, const WriteRGBA<SwapRB_>&, const Gamma* gamma)
+        {
+            if (gamma) {
+                lookupPixels<4, SwapRB_>(line + 4 * x, dst, count, *gamma);
+            }
+            else if (SwapRB_) {
+                RowKernels::swapRedBlue32(line + 4 * x, dst, count);
+            }
+            else {
+                std::memcpy(dst, line + 4 * x, 4 * static_cast<size_t>(count));
+            }
+            return true;
+        }
+    };
+
+    template <>
+    struct RowKernel<ReadGrayF, WriteGray>
+    {
+        static bool run(const uint8_t* line, int64_t x, uint8_t* dst, uint32_t count, const WriteGray&, const Gamma* gamma)
+        {
+            RowKernels::floatToBytes(reinterpret_cast<const float*>(line) + x, 1, dst, count, 1.0f, gammaValue(gamma));
+            return true;
+        }
+    };
+
+    template <>
+    struct RowKernel<ReadRGBF, WriteRGB<false>>
+    {
+        static bool run(const uint8_t* line, int64_t x, uint8_t* dst, uint32_t count, const WriteRGB<false>&, const Gamma* gamma)
+        {
+            RowKernels::floatToBytes(reinterpret_cast<const float*>(line) + 3 * x, 3, dst, count, 1.0f, gammaValue(gamma));
+            return true;
+        }
+    };
+
+    template <>
+    struct RowKernel<ReadRGBAF, WriteRGBA<false>>
+    {
+        static bool run(const uint8_t* line, int64_t x, uint8_t* dst, uint32_t count, const WriteRGBA<false>&, const Gamma* gamma)
+        {
+            RowKernels::floatToBytes(reinterpret_cast<const float*>(line) + 4 * x, 4, dst, count, 1.0f, gammaValue(gamma));
+            return true;
+        }
+    };
+
+    template <>
+    struct RowKernel<ReadGrayH, WriteGray>
+    {
+        static bool run(const uint8_t* line, int64_t x, uint8_t* dst, uint32_t count, const WriteGray&, const Gamma* gamma)
+        {
+            RowKernels::halfToBytes(reinterpret_cast<const uint16_t*>(line) + x, 1, dst, count, 1.0f, gammaValue(gamma));
+            return true;
+        }
+    };
+
+    template <>
+    struct RowKernel<ReadRGBH, WriteRGB<false>>
+    {
+        static bool run(const uint8_t* line, int64_t x, uint8_t* dst, uint32_t count, const WriteRGB<false>&, const Gamma* gamma)
+        {
+            RowKernels::halfToBytes(reinterpret_cast<const uint16_t*>(line) + 3 * x, 3, dst, count, 1.0f, gammaValue(gamma));
+            return true;
+        }
+    };
+
+    template <>
+    struct RowKernel<ReadRGBAH, WriteRGBA<false>>
+    {
+        static bool run(const uint8_t* line, int64_t x, uint8_t* dst, uint32_t count, const WriteRGBA<false>&, const Gamma* gamma)
+        {
+            RowKernels::halfToBytes(reinterpret_cast<const uint16_t*>(line) + 4 * x, 4, dst, count, 1.0f, gammaValue(gamma));
+            return true;
+        }
+    };
+
+
+    /**
+     * Affine mapping of destination scanline to the source
+     */
+    class InverseTransform
+    {
+    public:
+        InverseTransform(FIBITMAP* src, FIBITMAP* dst, const ProcessingParams& params)
+            : mSrcWidth(FreeImage_GetWidth(src)), mSrcHeight(FreeImage_GetHeight(src))
+            , mDstWidth(FreeImage_GetWidth(dst)), mDstHeight(FreeImage_GetHeight(dst))
+            , mParams(params)
+        { }
+
+        /**
+         * Source scanline and column of the destination pixel. Bitmaps are stored bottom-up.
+         */
+        void map(int64_t dstLine, int64_t dstX, int64_t* srcLine, int64_t* srcX) const
+        {
+            // top-down display coordinates
+            int64_t y = mDstHeight - 1 - dstLine;
+            int64_t x = dstX;
+            if (mParams.flips[FlipType::eHorizontal]) {
+                x = mDstWidth - 1 - x;
+            }
+            if (mParams.flips[FlipType::eVertical]) {
+                y = mDstHeight - 1 - y;
+            }
+            int64_t sy = y;
+            int64_t sx = x;
+            switch (mParams.rotation) {
+            case Rotation::eDegree90:
+                sy = x;
+                sx = mSrcWidth - 1 - y;
+                break;
+            case Rotation::eDegree180:
+                sy = mSrcHeight - 1 - y;
+                sx = mSrcWidth  - 1 - x;
+                break;
+            case Rotation::eDegree270:
+                sy = mSrcHeight - 1 - x;
+                sx = y;
+                break;
+            default:
+                break;
+            }
+            *srcLine = mSrcHeight - 1 - sy;
+            *srcX = sx;
+        }
+
+    private:
+        int64_t mSrcWidth;
+        int64_t mSrcHeight;
+        int64_t mDstWidth;
+        int64_t mDstHeight;
+        const ProcessingParams& mParams;
+    };
+
+
+    template <typename Reader_, typename Writer_, bool UseGamma_>
+    void processImpl(FIBITMAP* src, FIBITMAP* dst, const ProcessingParams& params, const Writer_& writer)
+    {
+        const uint8_t* srcBits = FreeImage_GetBits(src);
+        const int64_t srcPitch = FreeImage_GetPitch(src);
+        const uint32_t dstWidth  = FreeImage_GetWidth(dst);
+        const uint32_t dstHeight = FreeImage_GetHeight(dst);
+
+        const Gamma gamma(params.gamma);
+        const InverseTransform transform(src, dst, params);
+
+        parallelFor(dstHeight, dstWidth, [&](uint32_t lineBegin, uint32_t lineEnd) {
+            for (uint32_t dstLine = lineBegin; dstLine < lineEnd; ++dstLine) {
+                int64_t srcLine0 = 0, srcX0 = 0, srcLine1 = 0, srcX1 = 0;
+                transform.map(dstLine, 0, &srcLine0, &srcX0);
+                transform.map(dstLine, 1, &srcLine1, &srcX1);
+                // Stepping along destination line moves either along source line or column
+                const int64_t lineStep = (srcLine1 - srcLine0) * srcPitch;
+                const int64_t xStep    = srcX1 - srcX0;
+
+                const uint8_t* srcPtr = srcBits + srcLine0 * srcPitch;
+                int64_t srcX = srcX0;
+                uint8_t* dstPtr = FreeImage_GetScanLine(dst, static_cast<int>(dstLine));
+                if (lineStep == 0 && xStep == 1 && RowKernel<Reader_, Writer_>::run(srcPtr, srcX, dstPtr, dstWidth, writer, UseGamma_ ? &gamma : nullptr)) {
+                    continue;
+                }
+                for (uint32_t x = 0; x < dstWidth; ++x, srcPtr += lineStep, srcX += xStep) {
+                    writer.write(dstPtr, x, Reader_::template read<UseGamma_>(srcPtr, srcX, gamma));
+                }
+            }
+        });
+    }
+
+    template <typename Reader_, typename Writer_>
+    void processWithWriter(FIBITMAP* src, FIBITMAP* dst, const ProcessingParams& params, const Writer_& writer)
+    {
+        if (params.gamma != 1.0) {
+            processImpl<Reader_, Writer_, true>(src, dst, params, writer);
+        }
+        else {
+            processImpl<Reader_, Writer_, false>(src, dst, params, writer);
+        }
+    }
+
+    template <typename Reader_>
+    void processWithReader(FIBITMAP* src, FIBITMAP* dst, const ProcessingParams& params, ChannelSwizzle swizzle)
+    {
+        const bool swap = (swizzle == ChannelSwizzle::eBGR);
+        switch (FreeImage_GetBPP(dst)) {
+        case 8:
+            processWithWriter<Reader_>(src, dst, params, WriteGray{ swizzle });
+            break;
+        case 24:
+            if (swap) {
+                processWithWriter<Reader_>(src, dst, params, WriteRGB<true>{});
+            }
+            else {
+                processWithWriter<Reader_>(src, dst, params, WriteRGB<false>{});
+            }
+            break;
+        case 32:
+            if (swap) {
+                processWithWriter<Reader_>(src, dst, params, WriteRGBA<true>{});
+            }
+            else {
+                processWithWriter<Reader_>(src, dst, params, WriteRGBA<false>{});
+            }
+            break;
+        default:
+            throw std::logic_error("FusedKernel[run]: Unsupported destination bitmap");
+        }
+    }
+
+    uint32_t sourceChannels(FIBITMAP* src)
+    {
+        return pixelChannels(pixelFormat(src));
+    }
+
+    /**
+     * Swizzle which can be applied to the source
+     */
+    ChannelSwizzle effectiveSwizzle(FIBITMAP* src, ChannelSwizzle swizzle)
+    {
+        const uint32_t channels = sourceChannels(src);
+        if (channels < 3 || (swizzle == ChannelSwizzle::eAlpha && channels < 4)) {
+            return ChannelSwizzle::eRGB;
+        }
+        return swizzle;
+    }
+}
+
+uint32_t FusedKernel::outputBpp(FIBITMAP* src, const ProcessingParams& params)
+{
+    if (!src) {
+        return 0;
+    }
+    const uint32_t channels = sourceChannels(src);
+    switch (effectiveSwizzle(src, params.swizzle)) {
+    case ChannelSwizzle::eRGB:
+    case ChannelSwizzle::eBGR:
+        return (channels == 1) ? 8 : 8 * channels;
+    default:
+        return 8;
+    }
+}
+
+void FusedKernel::outputSize(FIBITMAP* src, Rotation rotation, uint32_t* width, uint32_t* height)
+{
+    assert(src && width && height);
+    if (rotation == Rotation::eDegree90 || rotation == Rotation::eDegree270) {
+        *width  = FreeImage_GetHeight(src);
+        *height = FreeImage_GetWidth(src);
+    }
+    else {
+        *width  = FreeImage_GetWidth(src);
+        *height = FreeImage_GetHeight(src);
+    }
+}
+
+bool FusedKernel::isIdentity(FIBITMAP* src, const ProcessingParams& params)
+{
+    return src && (FreeImage_GetImageType(src) == FIT_BITMAP) && (params.rotation == Rotation::eDegree0)
+        && !params.flips[FlipType::eHorizontal] && !params.flips[FlipType::eVertical]
+        && (params.gamma == 1.0) && (effectiveSwizzle(src, params.swizzle) == ChannelSwizzle::eRGB);
+}
+
+void FusedKernel::run(FIBITMAP* src, FIBITMAP* dst, const ProcessingParams& params)
+{
+    if (!src || !dst) {
+        throw std::runtime_error("FusedKernel[run]: Null bitmap");
+    }
+    uint32_t width = 0, height = 0;
+    outputSize(src, params.rotation, &width, &height);
+    if (FreeImage_GetWidth(dst) != width || FreeImage_GetHeight(dst) != height || FreeImage_GetBPP(dst) != outputBpp(src, params)) {
+        throw std::logic_error("FusedKernel[run]: Destination bitmap has wrong layout");
+    }
+
+    const ChannelSwizzle swizzle = effectiveSwizzle(src, params.swizzle);
+    const bool supported = visitPixels(pixelFormat(src), [&](auto traits) {
+        processWithReader<ReadPixel<decltype(traits)>>(src, dst, params, swizzle);
+    });
+    if (!supported) {
+        throw std::logic_error("FusedKernel[run]: Unsupported bitmap");
+    }
+}
+
@@ -0,0 +1,56 @@
+/**
+ * @file
+ *
+ * Copyright 2018-2026 Alexey Gruzdev
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FUSEDKERNEL_H
+#define FUSEDKERNEL_H
+
+#include "FreeImageExt.h"
+#include "ProcessingParams.h"
+
+/**
+ * Single pass conversion of a frame to the displayable bitmap.
+ * Each destination pixel is mapped through inversed flip and rotation, then tone mapping by clamping,
+ * gamma and channels swizzle are applied, so every pixel is read and written once.
+ */
+class FusedKernel
+{
+public:
+    /**
+     * Returns bits per pixel of the destination bitmap, or 0 if the source type is not supported
+     */
+    static uint32_t outputBpp(FIBITMAP* src, const ProcessingParams& params);
+
+    /**
+     * Destination size after rotation
+     */
+    static void outputSize(FIBITMAP* src, Rotation rotation, uint32_t* width, uint32_t* height);
+
+    /**
+     * Returns true if the source can be displayed without any processing
+     */
+    static bool isIdentity(FIBITMAP* src, const ProcessingParams& params);
+
+    /**
+     * Processes src into dst. Destination must have outputBpp() and outputSize().
+     * Pages come as 8 bit, half, float or double bitmaps, since 16 bit integer pages are converted to float on loading.
+     * Floating point sources are tone mapped by clamping, other operators must be applied beforehand.
+     */
+    static void run(FIBITMAP* src, FIBITMAP* dst, const ProcessingParams& params);
+};
+
+#endif // FUSEDKERNEL_H
@@ -0,0 +1,393 @@
+/**
+ * @file
+ *
+ * Copyright 2018-2026 Alexey Gruzdev
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "GLCanvas.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QMatrix4x4>
+#include <QOpenGLContext>
+#include <QOpenGLPixelTransferOptions>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLTexture>
+#include <QSurfaceFormat>
+
+#include "PixelTraits.h"
+
+namespace
+{
+    constexpr int kAttributePosition = 0;
+    constexpr int kAttributeTexCoord = 1;
+
+    // Same as the raster checkerboard
+    constexpr float kCheckerboardCell  = 8.0f;
+
+    // GLSL 1.20 runs on any desktop compatibility context, see the constructor
+    const char* kVertexShader = R"(
+        #version 120
+        attribute vec2 aPosition;
+        attribute vec2 aTexCoord;
+        uniform mat4 uMatrix;
+        varying vec2 vTexCoord;
+        void main()
+        {
+            gl_Position = uMatrix * vec4(aPosition, 0.0, 1.0);
+            vTexCoord = aTexCoord;
+        }
+    )";
+
+    // Swizzle values are ChannelSwizzle
+    const char* kFragmentShader = R"(
+        #version 120
+        uniform sampler2D uTexture;
+        uniform int uChannels;
+        uniform int uSwizzle;
+        uniform float uLow;
+        uniform float uScale;
+        uniform float uGamma;
+        uniform vec3 uBackground;
+        uniform bool uCheckerboard;
+        uniform float uCheckerboardCell;
+        varying vec2 vTexCoord;
+        void main()
+        {
+            vec4 c = texture2D(uTexture, vTexCoord);
+            if (uChannels == 1) {
+                c = vec4(c.rrr, 1.0);
+            }
+            else if (uChannels == 3) {
+                c.a = 1.0;
+            }
+            c.rgb = pow(clamp((c.rgb - vec3(uLow)) * uScale, 0.0, 1.0), vec3(uGamma));
+            c.a = clamp(c.a, 0.0, 1.0);
+            if (uSwizzle == 1) {
+                c.rgb = c.bgr;
+            }
+            else if (uSwizzle == 2) {
+                c = vec4(c.rrr, 1.0);
+            }
+            else if (uSwizzle == 3) {
+                c = vec4(c.ggg, 1.0);
+            }
+            else if (uSwizzle == 4) {
+                c = vec4(c.bbb, 1.0);
+            }
+            else if (uSwizzle == 5) {
+                c = vec4(c.aaa, 1.0);
+            }
+            vec3 under = uBackground;
+            if (uCheckerboard) {
+                vec2 cell = floor(gl_FragCoord.xy / uCheckerboardCell);
+                under = (mod(cell.x + cell.y, 2.0) < 0.5) ? vec3(0.7529) : vec3(1.0);
+            }
+            gl_FragColor = vec4(mix(under, c.rgb, c.a), 1.0);
+        }
+    )";
+
+    struct TextureFormat
+    {
+        QOpenGLTexture::TextureFormat internal;
+        QOpenGLTexture::PixelFormat pixel;
+        QOpenGLTexture::PixelType type;
+        uint32_t pixelSize;
+    };
+
+    // 8 bit FreeImage pixels are stored in BGR order, other types in RGB order
+    bool textureFormat(PixelFormat format, TextureFormat* result)
+    {
+        switch (format) {
+        case PixelFormat::eGray8:
+            *result = { QOpenGLTexture::R8_UNorm, QOpenGLTexture::Red, QOpenGLTexture::UInt8, 1 };
+            return true;
+        case PixelFormat::eRGB8:
+            *result = { QOpenGLTexture::RGB8_UNorm, QOpenGLTexture::BGR, QOpenGLTexture::UInt8, 3 };
+            return true;
+        case PixelFormat::eRGBA8:
+            *result = { QOpenGLTexture::RGBA8_UNorm, QOpenGLTexture::BGRA, QOpenGLTexture::UInt8, 4 };
+            return true;
+        case PixelFormat::eGray16:
+            *result = { QOpenGLTexture::R16_UNorm, QOpenGLTexture::Red, QOpenGLTexture::UInt16, 2 };
+            return true;
+        case PixelFormat::eRGB16:
+            *result = { QOpenGLTexture::RGB16_UNorm, QOpenGLTexture::RGB, QOpenGLTexture::UInt16, 6 };
+            return true;
+        case PixelFormat::eRGBA16:
+            *result = { QOpenGLTexture::RGBA16_UNorm, QOpenGLTexture::RGBA, QOpenGLTexture::UInt16, 8 };
+            return true;
+        case PixelFormat::eGrayHalf:
+            *result = { QOpenGLTexture::R16F, QOpenGLTexture::Red, QOpenGLTexture::Float16, 2 };
+            return true;
+        case PixelFormat::eRGBHalf:
+            *result = { QOpenGLTexture::RGB16F, QOpenGLTexture::RGB, QOpenGLTexture::Float16, 6 };
+            return true;
+        case PixelFormat::eRGBAHalf:
+            *result = { QOpenGLTexture::RGBA16F, QOpenGLTexture::RGBA, QOpenGLTexture::Float16, 8 };
+            return true;
+        case PixelFormat::eGrayFloat:
+            *result = { QOpenGLTexture::R32F, QOpenGLTexture::Red, QOpenGLTexture::Float32, 4 };
+            return true;
+        case PixelFormat::eRGBFloat:
+            *result = { QOpenGLTexture::RGB32F, QOpenGLTexture::RGB, QOpenGLTexture::Float32, 12 };
+            return true;
+        case PixelFormat::eRGBAFloat:
+            *result = { QOpenGLTexture::RGBA32F, QOpenGLTexture::RGBA, QOpenGLTexture::Float32, 16 };
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    std::unique_ptr<QOpenGLTexture> createTexture(int width, int height, const TextureFormat& format, const void* data)
+    {
+        auto texture = std::make_unique<QOpenGLTexture>(QOpenGLTexture::Target2D);
+        texture->setSize(width, height);
+        texture->setFormat(format.internal);
+        texture->setMipLevels(texture->maximumMipLevels());
+        texture->allocateStorage(format.pixel, format.type);
+        if (!texture->isStorageAllocated()) {
+            return nullptr;
+        }
+        // Rows of FreeImage bitmaps and QImage are aligned to 4 bytes
+        QOpenGLPixelTransferOptions options;
+        options.setAlignment(4);
+        texture->setData(format.pixel, format.type, data, &options);
+        texture->generateMipMaps();
+        texture->setWrapMode(QOpenGLTexture::ClampToEdge);
+        return texture;
+    }
+
+    ChannelSwizzle effectiveSwizzle(uint32_t channels, ChannelSwizzle swizzle)
+    {
+        if (channels < 3 || (swizzle == ChannelSwizzle::eAlpha && channels < 4)) {
+            return ChannelSwizzle::eRGB;
+        }
+        return swizzle;
+    }
+}
+
+GLCanvas::GLCanvas(QWidget* parent)
+    : QOpenGLWidget(parent)
+{
+    // Shaders are GLSL 1.20 with attribute, varying, texture2D and gl_FragColor, core profiles are not required to accept them
+    QSurfaceFormat surfaceFormat = format();
+    surfaceFormat.setRenderableType(QSurfaceFormat::OpenGL);
+    surfaceFormat.setVersion(3, 0);
+    surfaceFormat.setProfile(QSurfaceFormat::CompatibilityProfile);
+    setFormat(surfaceFormat);
+
+    // Input is handled by the parent canvas
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setFocusPolicy(Qt::NoFocus);
+}
+
+GLCanvas::~GLCanvas()
+{
+    if (isValid()) {
+        makeCurrent();
+        releaseTexture();
+        mProgram.reset();
+        doneCurrent();
+    }
+}
+
+bool GLCanvas::isSupported(FIBITMAP* frame)
+{
+    TextureFormat format{};
+    return frame && textureFormat(pixelFormat(frame), &format);
+}
+
+void GLCanvas::initializeGL()
+{
+    initializeOpenGLFunctions();
+    const QOpenGLContext* ctx = context();
+    // Single and two channel, 16 bit and floating point textures
+    mSupportsFormats = ctx && !ctx->isOpenGLES() && ctx->format().majorVersion() >= 3;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &mMaxTextureSize);
+
+    auto program = std::make_unique<QOpenGLShaderProgram>();
+    program->addShaderFromSourceCode(QOpenGLShader::Vertex, kVertexShader);
+    program->addShaderFromSourceCode(QOpenGLShader::Fragment, kFragmentShader);
+    program->bindAttributeLocation("aPosition", kAttributePosition);
+    program->bindAttributeLocation("aTexCoord", kAttributeTexCoord);
+    if (program->link()) {
+        mProgram = std::move(program);
+    }
+    else {
+        qWarning() << QString("GLCanvas[initializeGL]: ") + program->log();
+    }
+}
+
+void GLCanvas::releaseTexture()
+{
+    mTexture.reset();
+    mTextureKey = 0;
+}
+
+bool GLCanvas::upload(uint64_t key, FIBITMAP* frame)
+{
+    TextureFormat format{};
+    if (!textureFormat(pixelFormat(frame), &format)) {
+        return false;
+    }
+    const int width  = static_cast<int>(FreeImage_GetWidth(frame));
+    const int height = static_cast<int>(FreeImage_GetHeight(frame));
+    if (width > mMaxTextureSize || height > mMaxTextureSize) {
+        return false;
+    }
+    // Row length is not passed, so the pitch must be the packed row aligned to 4 bytes
+    const uint32_t packedPitch = (width * format.pixelSize + 3u) & ~3u;
+    if (FreeImage_GetPitch(frame) != packedPitch) {
+        return false;
+    }
+    makeCurrent();
+    releaseTexture();
+    mTexture = createTexture(width, height, format, FreeImage_GetBits(frame));
+    doneCurrent();
+    if (!mTexture) {
+        return false;
+    }
+    mTextureKey = key;
+    mTextureIsPixmap = false;
+    // First row of the texture is the bottom one
+    mTextureIsBottomUp = true;
+    mTextureChannels = pixelChannels(pixelFormat(frame));
+    return true;
+}
+
+bool GLCanvas::setFrame(uint64_t key, FIBITMAP* frame)
+{
+    if (!isValid() || !mProgram || !mSupportsFormats || !frame) {
+        return false;
+    }
+    if (mTexture && !mTextureIsPixmap && mTextureKey == key) {
+        return true;
+    }
+    if (!upload(key, frame)) {
+        return false;
+    }
+    update();
+    return true;
+}
+
+bool GLCanvas::setPixmap(const QPixmap& pixmap)
+{
+    if (!isValid() || !mProgram || pixmap.isNull()) {
+        return false;
+    }
+    const uint64_t key = static_cast<uint64_t>(pixmap.cacheKey());
+    if (mTexture && mTextureIsPixmap && mTextureKey == key) {
+        return true;
+    }
+    if (pixmap.width() > mMaxTextureSize || pixmap.height() > mMaxTextureSize) {
+        return false;
+    }
+    const QImage image = pixmap.toImage().convertToFormat(QImage::Format_RGBA8888);
+    makeCurrent();
+    releaseTexture();
+    mTexture = createTexture(image.width(), image.height(), { QOpenGLTexture::RGBA8_UNorm, QOpenGLTexture::RGBA, QOpenGLTexture::UInt8, 4 }, image.constBits());
+    doneCurrent();
+    if (!mTexture) {
+        return false;
+    }
+    mTextureKey = key;
+    mTextureIsPixmap = true;
+    mTextureIsBottomUp = false;
+    mTextureChannels = 4;
+    update();
+    return true;
+}
+
+void GLCanvas::setView(const QRectF& target, const QTransform& transform, bool smooth)
+{
+    if (mTarget != target || mTransform != transform || mSmooth != smooth) {
+        mTarget = target;
+        mTransform = transform;
+        mSmooth = smooth;
+        update();
+    }
+}
+
+void GLCanvas::setProcessing(const Processing& processing)
+{
+    if (mProcessing != processing) {
+        mProcessing = processing;
+        update();
+    }
+}
+
+void GLCanvas::setBackground(const QColor& color, bool checkerboard)
+{
+    if (mBackground != color || mCheckerboard != checkerboard) {
+        mBackground = color;
+        mCheckerboard = checkerboard;
+        update();
+    }
+}
+
+void GLCanvas::paintGL()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    glClearColor(mBackground.redF(), mBackground.greenF(), mBackground.blueF(), 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    if (mTexture && mProgram && !mTarget.isEmpty()) {
+        QMatrix4x4 projection;
+        projection.ortho(0.0f, static_cast<float>(width()), static_cast<float>(height()), 0.0f, -1.0f, 1.0f);
+
+        const GLfloat left   = static_cast<GLfloat>(mTarget.left());
+        const GLfloat right  = static_cast<GLfloat>(mTarget.right());
+        const GLfloat top    = static_cast<GLfloat>(mTarget.top());
+        const GLfloat bottom = static_cast<GLfloat>(mTarget.bottom());
+        const GLfloat positions[] = { left, top, right, top, left, bottom, right, bottom };
+        const GLfloat topRow    = mTextureIsBottomUp ? 1.0f : 0.0f;
+        const GLfloat bottomRow = 1.0f - topRow;
+        const GLfloat texCoords[] = { 0.0f, topRow, 1.0f, topRow, 0.0f, bottomRow, 1.0f, bottomRow };
+
+        mTexture->setMinificationFilter(mSmooth ? QOpenGLTexture::LinearMipMapLinear : QOpenGLTexture::Nearest);
+        mTexture->setMagnificationFilter(mSmooth ? QOpenGLTexture::Linear : QOpenGLTexture::Nearest);
+        mTexture->bind(0);
+
+        const float range = mProcessing.high - mProcessing.low;
+        mProgram->bind();
+        mProgram->setUniformValue("uMatrix", projection * QMatrix4x4(mTransform));
+        mProgram->setUniformValue("uTexture", 0);
+        mProgram->setUniformValue("uChannels", static_cast<GLint>(mTextureChannels));
+        mProgram->setUniformValue("uSwizzle", static_cast<GLint>(effectiveSwizzle(mTextureChannels, mProcessing.swizzle)));
+        mProgram->setUniformValue("uLow", mProcessing.low);
+        mProgram->setUniformValue("uScale", (range > 0.0f) ? 1.0f / range : 1.0f);
+        mProgram->setUniformValue("uGamma", static_cast<GLfloat>(mProcessing.gamma));
+        mProgram->setUniformValue("uBackground", QVector3D(mBackground.redF(), mBackground.greenF(), mBackground.blueF()));
+        mProgram->setUniformValue("uCheckerboard", mCheckerboard);
+        mProgram->setUniformValue("uCheckerboardCell", static_cast<GLfloat>(kCheckerboardCell * devicePixelRatioF()));
+
+        mProgram->enableAttributeArray(kAttributePosition);
+        mProgram->enableAttributeArray(kAttributeTexCoord);
+        mProgram->setAttributeArray(kAttributePosition, GL_FLOAT, positions, 2);
+        mProgram->setAttributeArray(kAttributeTexCoord, GL_FLOAT, texCoords, 2);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        mProgram->disableAttributeArray(kAttributeTexCoord);
+        mProgram->disableAttributeArray(kAttributePosition);
+        mProgram->release();
+        mTexture->release();
+    }
+    if (mMeasureTime) {
+        glFinish();
+    }
+    mPaintTime = timer.nsecsElapsed() / 1e6;
+}
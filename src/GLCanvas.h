@@ -0,0 +1,150 @@
+/**
+ * @file
+ *
+ * Copyright 2018-2026 Alexey Gruzdev
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GLCANVAS_H
+#define GLCANVAS_H
+
+#include <cstdint>
+#include <memory>
+
+#include <QColor>
+#include <QOpenGLFunctions>
+#include <QOpenGLWidget>
+#include <QPixmap>
+#include <QRectF>
+#include <QTransform>
+
+#include "FreeImageExt.h"
+#include "ProcessingParams.h"
+
+class QOpenGLShaderProgram;
+class QOpenGLTexture;
+
+/**
+ * OpenGL backend of the canvas.
+ * Frame is uploaded as a texture once, zoom, pan, rotation and flips are vertex transforms,
+ * while gamma, swizzle and clamp or linear tone mapping are applied in the fragment shader.
+ * Requests a desktop OpenGL 3.0 compatibility context, which is also provided by software renderers such as Mesa llvmpipe.
+ * Older desktop contexts only show processed pixmaps, OpenGL ES falls back to the raster path.
+ */
+class GLCanvas
+    : public QOpenGLWidget
+    , protected QOpenGLFunctions
+{
+public:
+    /**
+     * Per pixel processing done by the shader
+     */
+    struct Processing
+    {
+        double gamma = 1.0;
+        ChannelSwizzle swizzle = ChannelSwizzle::eRGB;
+        // Color values are mapped from [low, high] to [0, 1] and clamped
+        float low  = 0.0f;
+        float high = 1.0f;
+
+        bool operator==(const Processing& other) const
+        {
+            return gamma == other.gamma && swizzle == other.swizzle && low == other.low && high == other.high;
+        }
+
+        bool operator!=(const Processing& other) const
+        {
+            return !(*this == other);
+        }
+    };
+
+    explicit GLCanvas(QWidget* parent);
+
+    ~GLCanvas() override;
+
+    /**
+     * True if the bitmap can be uploaded as is: 8 and 16 bit, half and single precision greyscale, RGB and RGBA
+     */
+    static bool isSupported(FIBITMAP* frame);
+
+    /**
+     * Uploads the unprocessed frame, if the key changed.
+     * Returns false if the frame can't be uploaded, then the raster path must be used.
+     */
+    bool setFrame(uint64_t key, FIBITMAP* frame);
+
+    /**
+     * Uploads the processed top-down pixmap, if it changed.
+     * Returns false if the pixmap can't be uploaded, then the raster path must be used.
+     */
+    bool setPixmap(const QPixmap& pixmap);
+
+    /**
+     * Places the texture into the target rectangle, which is mapped to the widget by the transform
+     */
+    void setView(const QRectF& target, const QTransform& transform, bool smooth);
+
+    void setProcessing(const Processing& processing);
+
+    void setBackground(const QColor& color, bool checkerboard);
+
+    /**
+     * Makes paintTime() include waiting for the GPU
+     */
+    void setMeasureTime(bool enable)
+    {
+        mMeasureTime = enable;
+    }
+
+    /**
+     * Duration of the last paintGL() in milliseconds
+     */
+    double paintTime() const
+    {
+        return mPaintTime;
+    }
+
+protected:
+    void initializeGL() override;
+
+    void paintGL() override;
+
+private:
+    bool upload(uint64_t key, FIBITMAP* frame);
+
+    void releaseTexture();
+
+    std::unique_ptr<QOpenGLShaderProgram> mProgram;
+    std::unique_ptr<QOpenGLTexture> mTexture;
+    bool mSupportsFormats = false;
+    int mMaxTextureSize = 0;
+
+    // Either frame generation or pixmap cache key
+    uint64_t mTextureKey = 0;
+    bool mTextureIsPixmap = false;
+    bool mTextureIsBottomUp = false;
+    uint32_t mTextureChannels = 4;
+
+    QRectF mTarget;
+    QTransform mTransform;
+    bool mSmooth = false;
+    Processing mProcessing;
+    QColor mBackground;
+    bool mCheckerboard = false;
+
+    bool mMeasureTime = false;
+    double mPaintTime = 0.0;
+};
+
+#endif // GLCANVAS_H
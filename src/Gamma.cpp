@@ -0,0 +1,31 @@
+/**
+ * @file
+ *
+ * Copyright 2018-2026 Alexey Gruzdev
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Gamma.h"
+
+#include <algorithm>
+#include <cmath>
+
+Gamma::Gamma(double value)
+    : mValue(value), mFloatValue(static_cast<float>(value))
+{
+    for (size_t i = 0; i < mLut.size(); ++i) {
+        mLut[i] = static_cast<uint8_t>(std::clamp(std::floor(255.0 * std::pow(i / 255.0, value) + 0.5), 0.0, 255.0));
+    }
+}
+
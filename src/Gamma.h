@@ -0,0 +1,101 @@
+/**
+ * @file
+ *
+ * Copyright 2018-2026 Alexey Gruzdev
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GAMMA_H
+#define GAMMA_H
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Gamma correction v^gamma for normalized values.
+ * 8 bit values use precomputed table, floating point values use fast pow approximation.
+ */
+class Gamma
+{
+public:
+    explicit
+    Gamma(double value);
+
+    double value() const
+    {
+        return mValue;
+    }
+
+    uint8_t operator()(uint8_t v) const
+    {
+        return mLut[v];
+    }
+
+    float operator()(float v) const
+    {
+        return (v > 0.0f) ? fastPow(v, mFloatValue) : 0.0f;
+    }
+
+    /**
+     * Approximation of x^p for x > 0 with relative error below 1e-4.
+     * Results below 2^-126 are clamped
+     */
+    static
+    float fastPow(float x, float p)
+    {
+        return fastExp2(p * fastLog2(x));
+    }
+
+private:
+    // Polynomial approximations without tables and divisions
+
+    static
+    float fastLog2(float x)
+    {
+        // x = 2^e * (1 + m), m in [0, 1)
+        uint32_t bits = 0;
+        std::memcpy(&bits, &x, sizeof(bits));
+        const float e = static_cast<float>(static_cast<int32_t>(bits >> 23) - 127);
+        bits = (bits & 0x007FFFFFu) | 0x3F800000u;
+        float m = 0.0f;
+        std::memcpy(&m, &bits, sizeof(m));
+        m -= 1.0f;
+        // Least squares fit of log2(1 + m), absolute error 2.5e-6
+        const float p = m * (1.44253478f + m * (-0.718033591f + m * (0.457158125f + m * (-0.277341653f + m * (0.121472954f + m * -0.0257923470f)))));
+        return e + p;
+    }
+
+    static
+    float fastExp2(float x)
+    {
+        x = (x > -126.0f) ? x : -126.0f;
+        x = (x < 127.0f) ? x : 127.0f;
+        // 2^x = 2^i * 2^f, f in [0, 1)
+        // Truncation of a non-negative value is floor
+        const int32_t i = static_cast<int32_t>(x + 126.0f) - 126;
+        const float f = (x - static_cast<float>(i)) * 0.693147181f;
+        const float ef = 1.0f + f * (1.0f + f * (1.0f / 2.0f + f * (1.0f / 6.0f + f * (1.0f / 24.0f + f * (1.0f / 120.0f + f * (1.0f / 720.0f))))));
+        const uint32_t bits = static_cast<uint32_t>(i + 127) << 23;
+        float scale = 0.0f;
+        std::memcpy(&scale, &bits, sizeof(scale));
+        return scale * ef;
+    }
+
+    double mValue;
+    float mFloatValue;
+    std::array<uint8_t, 256> mLut;
+};
+
+#endif // GAMMA_H
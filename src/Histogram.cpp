@@ -17,6 +17,7 @@
  */
 
 #include "Histogram.h"
+#include "FreeImageExt.h"
 
 namespace {
     union ValueStorage {
@@ -38,6 +39,11 @@ bool Histogram::FillFromBitmap(FIBITMAP* bmp)
     if (mPixelsNumber == 0) {
         return false;
     }
+    if (FreeImageExt_IsHalf(bmp)) {
+        // FreeImage doesn't know half precision, the histogram is built from a temporary float copy
+        UniqueBitmap expanded(FreeImageExt_ConvertFromHalf(bmp), &::FreeImage_Unload);
+        return expanded && FillFromBitmap(expanded.get());
+    }
     ValueStorage minValStorage, maxValStorage;
     if (!FreeImage_MakeHistogram(bmp, rgbl.size() / 4, &minValStorage, &maxValStorage, rgbl.data(), 4, rgbl.data() + 1, 4, rgbl.data() + 2, 4, rgbl.data() + 3, 4)) {
         return false;
@@ -111,6 +111,9 @@ uint32_t Image::channels() const
 void Image::next()
 {
     if (mImagePlayer) {
+        for (auto listener : mListeners) {
+            listener->onAboutToInvalidate(this);
+        }
         mImagePlayer->next();
         if (!mInfo.animated) {
             mInfo.dims.width  = mImagePlayer->getWidth();
@@ -125,6 +128,9 @@ void Image::next()
 void Image::prev()
 {
     if (mImagePlayer) {
+        for (auto listener : mListeners) {
+            listener->onAboutToInvalidate(this);
+        }
         mImagePlayer->prev();
         if (!mInfo.animated) {
             mInfo.dims.width  = mImagePlayer->getWidth();
@@ -37,6 +37,11 @@ class ImageListener
 public:
     virtual ~ImageListener() = default;
 
+    /**
+     * Called before the current frame is replaced, while its bitmap is still alive
+     */
+    virtual void onAboutToInvalidate(Image*) { };
+
     virtual void onInvalidated(Image*) { };
 };
 
@@ -96,6 +101,11 @@ public:
         return mImagePlayer ? mImagePlayer->framesNumber() : 0;
     }
 
+    PlaybackStats playbackStats() const
+    {
+        return mImagePlayer ? mImagePlayer->getStats() : PlaybackStats{};
+    }
+
     /**
      * Current page access
      */
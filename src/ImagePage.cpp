@@ -28,6 +28,11 @@ namespace
     {
         assert(src != nullptr);
         FIBITMAP* result = nullptr;
+        if (FreeImageExt_IsHalf(src)) {
+            flags = (FreeImage_GetImageType(src) == FIT_UINT16) ? FrameFlags::eHRD : (FrameFlags::eHRD | FrameFlags::eRGB);
+            dstNeedUnload = false;
+            return src;
+        }
         const uint32_t bpp = FreeImage_GetBPP(src);
         switch (FreeImage_GetImageType(src)) {
         case FIT_RGBAF:
@@ -207,7 +212,13 @@ UniqueBitmap ImagePage::getOrMakeThumbnail(uint32_t maxSize) const
     else if (mConvertedBitmap) {
         FIBITMAP* ldrFrame = mConvertedBitmap;
         if ((mFlags & FrameFlags::eHRD) != FrameFlags::eNone) {
-            ldrFrame = FreeImage_ToneMapping(mConvertedBitmap, FITMO_LINEAR);
+            if (FreeImageExt_IsHalf(mConvertedBitmap)) {
+                UniqueBitmap hdrFrame(FreeImageExt_ConvertFromHalf(mConvertedBitmap), &::FreeImage_Unload);
+                ldrFrame = FreeImage_ToneMapping(hdrFrame.get(), FITMO_LINEAR);
+            }
+            else {
+                ldrFrame = FreeImage_ToneMapping(mConvertedBitmap, FITMO_LINEAR);
+            }
         }
         if (ldrFrame) {
             const unsigned w = FreeImage_GetWidth(ldrFrame);
@@ -18,8 +18,11 @@
 
 #include "ImageProcessor.h"
 
+#include <chrono>
 #include <stdexcept>
+#include "FusedKernel.h"
 #include "ImagePage.h"
+#include "Parallel.h"
 
 namespace
 {
@@ -47,142 +50,450 @@ namespace
         }
         return imageView;
     }
+
+    bool needsToneMapping(FIBITMAP* bmp, const ProcessingParams& params)
+    {
+        // Clamping is done by the kernel
+        const auto imgType = FreeImage_GetImageType(bmp);
+        return params.toneMapping != FITMO_CLAMP && (imgType == FIT_RGBF || imgType == FIT_RGBAF || imgType == FIT_FLOAT || imgType == FIT_DOUBLE || FreeImageExt_IsHalf(bmp));
+    }
+
+    /**
+     * Copies a top-down region of FIT_DOUBLE bitmap as FIT_FLOAT
+     */
+    FIBITMAP* copyDoubleAsFloat(FIBITMAP* src, const QRect& region)
+    {
+        const uint32_t width  = static_cast<uint32_t>(region.width());
+        const uint32_t height = static_cast<uint32_t>(region.height());
+        FIBITMAP* dst = FreeImage_AllocateT(FIT_FLOAT, width, height);
+        if (!dst) {
+            return nullptr;
+        }
+        // Scanlines are bottom-up
+        const int srcFirstLine = static_cast<int>(FreeImage_GetHeight(src)) - region.bottom() - 1;
+        parallelFor(height, width, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t y = begin; y < end; ++y) {
+                const auto srcLine = reinterpret_cast<const double*>(FreeImage_GetScanLine(src, srcFirstLine + static_cast<int>(y))) + region.left();
+                const auto dstLine = reinterpret_cast<float*>(FreeImage_GetScanLine(dst, static_cast<int>(y)));
+                for (uint32_t x = 0; x < width; ++x) {
+                    dstLine[x] = static_cast<float>(srcLine[x]);
+                }
+            }
+        });
+        return dst;
+    }
+
+    /**
+     * Region is top-down, same as FreeImage rectangles, size must not exceed the region size
+     */
+    FIBITMAP* resampleRegion(FIBITMAP* src, const QRect& region, const QSize& size)
+    {
+        const int top    = region.top();
+        const int bottom = region.bottom() + 1;
+        const bool isHalf = FreeImageExt_IsHalf(src);
+        if (isHalf || FreeImage_GetImageType(src) == FIT_DOUBLE) {
+            // FreeImage filters know neither half nor double precision, so the region is converted to float first
+            UniqueBitmap converted(isHalf ? FreeImageExt_ConvertFromHalf(src, region.left(), top, region.right() + 1, bottom) : copyDoubleAsFloat(src, region), &::FreeImage_Unload);
+            if (!converted || size == region.size()) {
+                return converted.release();
+            }
+            return FreeImage_Rescale(converted.get(), size.width(), size.height(), FILTER_BOX);
+        }
+        if (size == region.size()) {
+            return FreeImage_Copy(src, region.left(), top, region.right() + 1, bottom);
+        }
+        return FreeImage_RescaleRect(src, size.width(), size.height(), region.left(), top, region.right() + 1, bottom, FILTER_BOX);
+    }
+
+    /**
+     * FreeImage operators don't know half precision, so such frames are expanded first
+     */
+    FIBITMAP* applyToneMapping(FIBITMAP* src, const ProcessingParams& params)
+    {
+        if (FreeImageExt_IsHalf(src)) {
+            UniqueBitmap expanded(FreeImageExt_ConvertFromHalf(src), &::FreeImage_Unload);
+            if (!expanded) {
+                return nullptr;
+            }
+            return FreeImage_ToneMapping(expanded.get(), params.toneMapping, params.toneMappingFirst, params.toneMappingSecond);
+        }
+        return FreeImage_ToneMapping(src, params.toneMapping, params.toneMappingFirst, params.toneMappingSecond);
+    }
 }
 
 ImageProcessor::ImageProcessor()
     : mProcessBuffer(nullptr, &::FreeImage_Unload)
+    , mToneMappingBuffer(nullptr, &::FreeImage_Unload)
+    , mViewportBuffer(nullptr, &::FreeImage_Unload)
+    , mPreviewSource(nullptr, &::FreeImage_Unload)
+    , mPreviewBuffer(nullptr, &::FreeImage_Unload)
 { }
 
-ImageProcessor::~ImageProcessor() = default;
+ImageProcessor::~ImageProcessor()
+{
+    finishJob(false);
+    finishPreviewJob(false);
+}
 
-FIBITMAP* ImageProcessor::process(const Image& img)
+FIBITMAP* ImageProcessor::process(FIBITMAP* src, const ProcessingParams& params, const QRect& region, const QSize& size)
 {
-    FIBITMAP* originalBitmap = img.getBitmap();
-    if (!originalBitmap) {
-        throw std::logic_error("Image returned empty bitmap");
+    FIBITMAP* target = src;
+
+    if (region.isEmpty() && FusedKernel::isIdentity(target, params)) {
+        return target;
     }
-    FIBITMAP* target = originalBitmap;
 
-    // 1. Tonemap
-    auto imgType = FreeImage_GetImageType(target);
-    if (imgType == FIT_RGBF || imgType == FIT_RGBAF || imgType == FIT_FLOAT || imgType == FIT_DOUBLE) {
-        UniqueBitmap tonemapped(FreeImage_ToneMapping(target, mToneMapping), &::FreeImage_Unload);
-        if (tonemapped) {
-            mProcessBuffer = std::move(tonemapped);
-            target = mProcessBuffer.get();
-        }
+    // 1. Tone mapping operators need global statistics, so they can't be fused
+    if (needsToneMapping(target, params)) {
+        target = toneMap(target, params);
+    }
+    else {
+        resetToneMapping();
     }
 
-    // 2. Rotate
-    if (mRotation != Rotation::eDegree0) {
-        UniqueBitmap rotated(FreeImage_Rotate(target, static_cast<double>(toDegree(mRotation))), &::FreeImage_Unload);
-        if (rotated) {
-            mProcessBuffer = std::move(rotated);
-            target = mProcessBuffer.get();
+    // 2. Only the visible part in screen resolution. Goes after tone mapping, since operators depend on the whole frame.
+    if (!region.isEmpty()) {
+        mViewportBuffer.reset(resampleRegion(target, region, size));
+        if (!mViewportBuffer) {
+            throw std::runtime_error("ImageProcessor[process]: Failed to resample bitmap");
+        }
+        target = mViewportBuffer.get();
+        if (FusedKernel::isIdentity(target, params)) {
+            return target;
         }
     }
 
-    // 3. Flip
-    if (mFlips[FlipType::eHorizontal]) {
-        if (target == originalBitmap) {
-            mProcessBuffer.reset(FreeImage_Clone(originalBitmap));
-            target = mProcessBuffer.get();
-        }
-        FreeImage_FlipHorizontal(target);
+    // 3. Rotate, flip, gamma and swizzle in one pass
+    const uint32_t bpp = FusedKernel::outputBpp(target, params);
+    if (!bpp) {
+        throw std::logic_error("ImageProcessor[process]: Unsupported bitmap type");
     }
-    if (mFlips[FlipType::eVertical]) {
-        if (target == originalBitmap) {
-            mProcessBuffer.reset(FreeImage_Clone(originalBitmap));
-            target = mProcessBuffer.get();
+    uint32_t width = 0, height = 0;
+    FusedKernel::outputSize(target, params.rotation, &width, &height);
+    if (!mProcessBuffer || FreeImage_GetWidth(mProcessBuffer.get()) != width || FreeImage_GetHeight(mProcessBuffer.get()) != height || FreeImage_GetBPP(mProcessBuffer.get()) != bpp) {
+        mProcessBuffer.reset(FreeImage_Allocate(width, height, bpp));
+        if (!mProcessBuffer) {
+            throw std::runtime_error("ImageProcessor[process]: Failed to allocate bitmap");
         }
-        FreeImage_FlipVertical(target);
     }
+    FusedKernel::run(target, mProcessBuffer.get(), params);
 
-    // 4. Gamma
-    if (mGammaValue != 1.0) {
-        imgType = FreeImage_GetImageType(target);
-        if (imgType == FIT_BITMAP) {
-            if (target == originalBitmap) {
-                mProcessBuffer.reset(FreeImage_Clone(originalBitmap));
-                target = mProcessBuffer.get();
-            }
-            FreeImage_AdjustGamma(target, 1.0 / mGammaValue);
+    return mProcessBuffer.get();
+}
+
+FIBITMAP* ImageProcessor::toneMap(FIBITMAP* src, const ProcessingParams& params)
+{
+    if (!mToneMappingBuffer || mToneMappingSource != src || mToneMappingMode != params.toneMapping || mToneMappingFirst != params.toneMappingFirst || mToneMappingSecond != params.toneMappingSecond) {
+        resetToneMapping();
+        mToneMappingBuffer.reset(applyToneMapping(src, params));
+        if (!mToneMappingBuffer) {
+            return src;
         }
+        mToneMappingSource = src;
+        mToneMappingMode = params.toneMapping;
+        mToneMappingFirst = params.toneMappingFirst;
+        mToneMappingSecond = params.toneMappingSecond;
     }
+    return mToneMappingBuffer.get();
+}
 
-    // 5. Swizzle
-    if (mSwizzleType != ChannelSwizzle::eRGB) {
-        UniqueBitmap swizzled(nullptr, &::FreeImage_Unload);
-        switch(mSwizzleType) {
-        case ChannelSwizzle::eBGR:
-            if (target == originalBitmap) {
-                mProcessBuffer.reset(FreeImage_Clone(originalBitmap));
-                target = mProcessBuffer.get();
-            }
-            SwapRedBlue32(target);
-            break;
+void ImageProcessor::resetToneMapping()
+{
+    mToneMappingBuffer.reset();
+    mToneMappingSource = nullptr;
+    mToneMappingMode = FITMO_CLAMP;
+    mToneMappingFirst = 0.0;
+    mToneMappingSecond = 0.0;
+}
 
-        case ChannelSwizzle::eRed:
-            swizzled.reset(FreeImage_GetChannel(target, FICC_RED));
-            break;
+QPixmap ImageProcessor::getPreviewPixmap(const QRect& region, const QSize& size)
+{
+    if (mPreviewJob && mPreviewJob->ready) {
+        finishPreviewJob(true);
+    }
+    const auto pImg = mSrcImage.lock();
+    if (!pImg || !pImg->notNull()) {
+        return QPixmap();
+    }
+    FIBITMAP* bitmap = pImg->getBitmap();
+    if (!bitmap) {
+        throw std::logic_error("Image returned empty bitmap");
+    }
+    const int bitmapHeight = static_cast<int>(FreeImage_GetHeight(bitmap));
+    const QRect clipped = region.intersected(QRect(0, 0, static_cast<int>(FreeImage_GetWidth(bitmap)), bitmapHeight));
+    if (clipped.isEmpty() || size.isEmpty()) {
+        return QPixmap();
+    }
+    const QSize proxySize = size.boundedTo(clipped.size());
 
-        case ChannelSwizzle::eBlue:
-            swizzled.reset(FreeImage_GetChannel(target, FICC_BLUE));
-            break;
+    const bool upToDate = !mPreviewPixmap.isNull() && mPreviewResultGeneration == mGeneration && mPreviewResultRegion == clipped
+        && mPreviewResultSize == proxySize && mPreviewResultParams == viewParams();
+    if (!upToDate && !mPreviewJob) {
+        startPreviewJob(bitmap, clipped, proxySize);
+    }
+    return (mPreviewResultGeneration == mGeneration) ? mPreviewPixmap : QPixmap();
+}
 
-        case ChannelSwizzle::eGreen:
-            swizzled.reset(FreeImage_GetChannel(target, FICC_GREEN));
-            break;
+void ImageProcessor::startPreviewJob(FIBITMAP* bitmap, const QRect& region, const QSize& size)
+{
+    auto job = std::make_unique<PreviewJob>();
+    job->params = viewParams();
+    job->generation = mGeneration;
+    job->region = region;
+    job->size = size;
 
-        case ChannelSwizzle::eAlpha:
-            swizzled.reset(FreeImage_GetChannel(target, FICC_ALPHA));
-            break;
+    // Frame is kept alive until the job is finished, see onAboutToInvalidate()
+    PreviewJob* pJob = job.get();
+    job->task = std::async(std::launch::async, [this, pJob, bitmap]() {
+        try {
+            buildPreview(bitmap, *pJob);
+        }
+        catch (...) {
+            pJob->error = std::current_exception();
+        }
+        pJob->ready = true;
+        if (mOnResultReady) {
+            mOnResultReady();
+        }
+    });
+    mPreviewJob = std::move(job);
+}
 
-        default:
-            break;
+void ImageProcessor::buildPreview(FIBITMAP* bitmap, const PreviewJob& job)
+{
+    // Proxy is reused while only parameters change
+    if (!mPreviewSource || mPreviewGeneration != job.generation || mPreviewRegion != job.region || mPreviewSize != job.size) {
+        mPreviewSource.reset(resampleRegion(bitmap, job.region, job.size));
+        if (!mPreviewSource) {
+            throw std::runtime_error("ImageProcessor[buildPreview]: Failed to resample bitmap");
         }
-        if (swizzled) {
-            mProcessBuffer = std::move(swizzled);
-            target = mProcessBuffer.get();
+        mPreviewRegion = job.region;
+        mPreviewSize = job.size;
+        mPreviewGeneration = job.generation;
+    }
+
+    FIBITMAP* target = mPreviewSource.get();
+    UniqueBitmap toneMapped(nullptr, &::FreeImage_Unload);
+    if (needsToneMapping(target, job.params)) {
+        toneMapped.reset(applyToneMapping(target, job.params));
+        if (toneMapped) {
+            target = toneMapped.get();
+        }
+    }
+    const uint32_t bpp = FusedKernel::outputBpp(target, job.params);
+    if (!bpp) {
+        throw std::logic_error("ImageProcessor[buildPreview]: Unsupported bitmap type");
+    }
+    const uint32_t width  = FreeImage_GetWidth(target);
+    const uint32_t height = FreeImage_GetHeight(target);
+    if (!mPreviewBuffer || FreeImage_GetWidth(mPreviewBuffer.get()) != width || FreeImage_GetHeight(mPreviewBuffer.get()) != height || FreeImage_GetBPP(mPreviewBuffer.get()) != bpp) {
+        mPreviewBuffer.reset(FreeImage_Allocate(width, height, bpp));
+        if (!mPreviewBuffer) {
+            throw std::runtime_error("ImageProcessor[buildPreview]: Failed to allocate bitmap");
         }
     }
+    FusedKernel::run(target, mPreviewBuffer.get(), job.params);
+}
 
-    mIsBuffered = (target == mProcessBuffer.get());
+void ImageProcessor::finishPreviewJob(bool takeResult)
+{
+    if (!mPreviewJob) {
+        return;
+    }
+    mPreviewJob->task.wait();
+    const auto job = std::move(mPreviewJob);
+    if (!takeResult || job->generation != mGeneration) {
+        return;
+    }
+    if (job->error) {
+        std::rethrow_exception(job->error);
+    }
+    // The buffer is not touched until the next preview job, so the view is safe to copy
+    mPreviewPixmap = QPixmap::fromImage(makeQImageView(mPreviewBuffer.get()));
+    mPreviewResultRegion = job->region;
+    mPreviewResultSize = job->size;
+    mPreviewResultParams = job->params;
+    mPreviewResultGeneration = job->generation;
+}
 
-    return target;
+ProcessingParams ImageProcessor::viewParams() const
+{
+    ProcessingParams params = mParams;
+    params.rotation = Rotation::eDegree0;
+    params.flips = { false };
+    // Kernel writes bitmap rows in reversed order, so the buffer is top-down as QImage expects
+    params.flips[FlipType::eVertical] = true;
+    return params;
 }
 
 const QPixmap& ImageProcessor::getResultPixmap()
 {
-    if (!mIsValid) {
+    if (mJob && mJob->ready) {
+        finishJob(true);
+    }
+    if (!mIsValid && !mJob) {
         const auto pImg = mSrcImage.lock();
         if (pImg && pImg->notNull()) {
-            mDstPixmap = QPixmap::fromImage(makeQImageView(process(*pImg)));
-            mIsValid = true;
+            FIBITMAP* bitmap = pImg->getBitmap();
+            if (!bitmap) {
+                throw std::logic_error("Image returned empty bitmap");
+            }
+            const QRect frameRect(0, 0, static_cast<int>(FreeImage_GetWidth(bitmap)), static_cast<int>(FreeImage_GetHeight(bitmap)));
+            const bool fullFrame = mViewport.isEmpty() || (mViewport == frameRect && mViewportSize == frameRect.size());
+            ProcessingParams params = viewParams();
+            params.flips[FlipType::eVertical] = false;
+            if (fullFrame && FusedKernel::isIdentity(bitmap, params)) {
+                // Nothing to compute but the order of rows, no reason to wait for a worker
+                mDstPixmap = QPixmap::fromImage(makeQImageView(bitmap).mirrored());
+                mResultRegion = frameRect;
+                mProcessingTime = 0.0;
+                mIsValid = true;
+            }
+            else {
+                startJob();
+            }
         }
     }
     return mDstPixmap;
 }
 
-const UniqueBitmap& ImageProcessor::getResultBitmap()
+QPixmap ImageProcessor::getResultPixmap(const QSize& size, bool resample)
 {
-    if (mIsValid && mIsBuffered) {
-        return mProcessBuffer;
+    const QPixmap& pixmap = getResultPixmap();
+    if (pixmap.isNull() || size.isEmpty() || size.width() >= pixmap.width() || size.height() >= pixmap.height()) {
+        return pixmap;
     }
-    else {
-        const auto pImg = mSrcImage.lock();
-        if (pImg && pImg->notNull()) {
-            const auto bmp = process(*pImg);
-            if (!mIsBuffered) {
-                mProcessBuffer.reset(FreeImage_Clone(bmp));
-                mIsBuffered = true;
-            }
-            mIsValid = true;
+    const qint64 key = pixmap.cacheKey();
+    if (mResampler.isRequested(key, size)) {
+        const QPixmap resampled = mResampler.result();
+        if (!resampled.isNull()) {
+            return resampled;
+        }
+    }
+    else if (mIsValid && resample) {
+        // Don't spend time on the result which is about to be replaced
+        mResampler.resample(key, pixmap.toImage(), size, mOnResultReady);
+    }
+    if (!mPyramid.isBuiltFor(key)) {
+        if (!mIsValid) {
+            return pixmap;
+        }
+        mPyramid.build(key, pixmap.toImage(), mOnResultReady);
+    }
+    const QPixmap level = mPyramid.level(static_cast<qreal>(size.width()) / pixmap.width());
+    return level.isNull() ? pixmap : level;
+}
+
+void ImageProcessor::startJob()
+{
+    const auto pImg = mSrcImage.lock();
+    FIBITMAP* bitmap = pImg->getBitmap();
+
+    auto job = std::make_unique<ProcessingJob>();
+    job->params = viewParams();
+    job->generation = mGeneration;
+    job->viewport = mViewport;
+    job->viewportSize = mViewportSize;
+
+    const QRect frameRect(0, 0, static_cast<int>(FreeImage_GetWidth(bitmap)), static_cast<int>(FreeImage_GetHeight(bitmap)));
+    job->region = mViewport.intersected(frameRect);
+    QSize size = mViewportSize.boundedTo(job->region.size());
+    if (job->region.isEmpty() || size.isEmpty() || (job->region == frameRect && size == frameRect.size())) {
+        job->region = QRect();
+        size = QSize();
+    }
+
+    // Frame is kept alive until the job is finished, see onAboutToInvalidate()
+    ProcessingJob* pJob = job.get();
+    job->task = std::async(std::launch::async, [this, pJob, bitmap, size]() {
+        try {
+            const auto start = std::chrono::steady_clock::now();
+            pJob->result = process(bitmap, pJob->params, pJob->region, size);
+            pJob->time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+        catch (...) {
+            pJob->error = std::current_exception();
+        }
+        pJob->ready = true;
+        if (mOnResultReady) {
+            mOnResultReady();
+        }
+    });
+    mJob = std::move(job);
+}
+
+void ImageProcessor::finishJob(bool takeResult)
+{
+    if (!mJob) {
+        return;
+    }
+    mJob->task.wait();
+    const auto job = std::move(mJob);
+    if (!takeResult || job->generation != mGeneration) {
+        return;
+    }
+    if (job->error) {
+        std::rethrow_exception(job->error);
+    }
+    // The buffer is not touched until the next job, so the view is safe to copy
+    mDstPixmap = QPixmap::fromImage(makeQImageView(job->result));
+    mResultRegion = job->region.isEmpty() ? QRect(QPoint(0, 0), mDstPixmap.size()) : job->region;
+    mProcessingTime = job->time;
+    // Parameters could change while the job was running
+    mIsValid = (job->params == viewParams() && job->viewport == mViewport && job->viewportSize == mViewportSize);
+}
+
+QTransform ImageProcessor::viewTransform() const
+{
+    // Rotation is counterclockwise, same as FreeImage_Rotate
+    QTransform transform = QTransform().rotate(-toDegree(mParams.rotation));
+    transform *= QTransform::fromScale(mParams.flips[FlipType::eHorizontal] ? -1.0 : 1.0, mParams.flips[FlipType::eVertical] ? -1.0 : 1.0);
+    return transform;
+}
+
+const UniqueBitmap& ImageProcessor::getResultBitmap()
+{
+    finishJob(true);
+    const auto pImg = mSrcImage.lock();
+    if (pImg && pImg->notNull()) {
+        FIBITMAP* original = pImg->getBitmap();
+        if (!original) {
+            throw std::logic_error("Image returned empty bitmap");
+        }
+        FIBITMAP* bmp = process(original, mParams);
+        if (bmp != mProcessBuffer.get()) {
+            mProcessBuffer.reset(FreeImage_Clone(bmp));
         }
     }
     return mProcessBuffer;
 }
 
+QImage ImageProcessor::getResultImage()
+{
+    finishJob(true);
+    const auto pImg = mSrcImage.lock();
+    if (!pImg || !pImg->notNull()) {
+        return QImage();
+    }
+    FIBITMAP* original = pImg->getBitmap();
+    if (!original) {
+        throw std::logic_error("Image returned empty bitmap");
+    }
+    // Reversed vertical flip makes the bitmap top-down, so the image can own it without copying
+    ProcessingParams params = mParams;
+    params.flips[FlipType::eVertical] = !params.flips[FlipType::eVertical];
+    FIBITMAP* bmp = process(original, params);
+    UniqueBitmap owned((bmp == mProcessBuffer.get()) ? mProcessBuffer.release() : FreeImage_Clone(bmp), &::FreeImage_Unload);
+    if (!owned) {
+        throw std::runtime_error("ImageProcessor[getResultImage]: Failed to allocate bitmap");
+    }
+    const QImage view = makeQImageView(owned.get());
+    QImage image(FreeImage_GetBits(owned.get()), view.width(), view.height(), view.bytesPerLine(), view.format(),
+        [](void* dib) { FreeImage_Unload(static_cast<FIBITMAP*>(dib)); }, owned.get());
+    owned.release();
+    return image;
+}
+
 void ImageProcessor::attachSource(QWeakPointer<Image> image)
 {
     detachSource();
@@ -197,6 +508,8 @@ void ImageProcessor::attachSource(QWeakPointer<Image> image)
 
 void ImageProcessor::detachSource()
 {
+    finishJob(false);
+    finishPreviewJob(false);
     if (mSrcImage) {
         const auto pImg = mSrcImage.lock();
         if(pImg) {
@@ -204,24 +517,66 @@ void ImageProcessor::detachSource()
         }
     }
     mProcessBuffer.reset();
+    mViewportBuffer.reset();
+    mPreviewSource.reset();
+    mPreviewBuffer.reset();
+    mPreviewPixmap = QPixmap();
+    mPreviewResultRegion = QRect();
+    mPyramid.reset();
+    mResampler.reset();
+    mDstPixmap = QPixmap();
+    mResultRegion = QRect();
+    resetToneMapping();
+    ++mGeneration;
     mIsValid = false;
 }
 
+void ImageProcessor::onAboutToInvalidate(Image* emitter)
+{
+    assert(emitter == mSrcImage.lock().get());
+    (void)emitter;
+    // Workers must not outlive the frame they read
+    finishJob(false);
+    finishPreviewJob(false);
+}
+
 void ImageProcessor::onInvalidated(Image* emitter)
 {
     assert(emitter == mSrcImage.lock().get());
     (void)emitter;
+    // Bitmap handle can be reused by the next frame, so tone mapping can't be keyed by the pointer only
+    resetToneMapping();
+    ++mGeneration;
     mIsValid = false;
 }
 
+FIBITMAP* ImageProcessor::getSourceBitmap() const
+{
+    const auto pImg = mSrcImage.lock();
+    if (!pImg || !pImg->notNull()) {
+        return nullptr;
+    }
+    return pImg->getBitmap();
+}
+
 uint32_t ImageProcessor::width() const
 {
-    return !mDstPixmap.isNull() ? mDstPixmap.width() : 0;
+    const auto pImg = mSrcImage.lock();
+    if (!pImg || !pImg->notNull()) {
+        return 0;
+    }
+    const bool transposed = (mParams.rotation == Rotation::eDegree90 || mParams.rotation == Rotation::eDegree270);
+    return transposed ? pImg->height() : pImg->width();
 }
 
 uint32_t ImageProcessor::height() const
 {
-    return !mDstPixmap.isNull() ? mDstPixmap.height() : 0;
+    const auto pImg = mSrcImage.lock();
+    if (!pImg || !pImg->notNull()) {
+        return 0;
+    }
+    const bool transposed = (mParams.rotation == Rotation::eDegree90 || mParams.rotation == Rotation::eDegree270);
+    return transposed ? pImg->width() : pImg->height();
 }
 
 bool ImageProcessor::getPixel(uint32_t y, uint32_t x, Pixel* p) const
@@ -229,15 +584,15 @@ bool ImageProcessor::getPixel(uint32_t y, uint32_t x, Pixel* p) const
     const auto pImg = mSrcImage.lock();
     bool success = false;
     if (pImg && p && y < height() && x < width()) {
-        if (mFlips[FlipType::eHorizontal]) {
+        if (mParams.flips[FlipType::eHorizontal]) {
             x = width() - 1 - x;
         }
-        if (mFlips[FlipType::eVertical]) {
+        if (mParams.flips[FlipType::eVertical]) {
             y = height() - 1 - y;
         }
         uint32_t srcY = y;
         uint32_t srcX = x;
-        switch(mRotation) {
+        switch(mParams.rotation) {
             case Rotation::eDegree90:
                 srcY = x;
                 srcX = pImg->width() - 1 - y;
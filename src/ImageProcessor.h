@@ -19,50 +19,20 @@
 #ifndef IMAGEPROCESSOR_H
 #define IMAGEPROCESSOR_H
 
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+
 #include <QSharedPointer>
 #include <QPixmap>
+#include <QTransform>
 
 #include "FreeImageExt.h"
-#include "EnumArray.h"
 #include "Image.h"
-
-enum class Rotation
-{
-    eDegree0   = 0,
-    eDegree90  = 1,
-    eDegree180 = 2,
-    eDegree270 = 3,
-
-    length_
-};
-
-constexpr
-int toDegree(Rotation r)
-{
-    return 90 * static_cast<int>(r);
-}
-
-enum class FlipType
-{
-    eHorizontal,
-    eVertical,
-
-    length_
-};
-
-
-enum class ChannelSwizzle
-{
-    eRGB = 0,
-    eBGR,
-    eRed,
-    eGreen,
-    eBlue,
-    eAlpha,
-
-    length_
-};
-
+#include "MipPyramid.h"
+#include "ProcessingParams.h"
+#include "Resampler.h"
 
 class ImageProcessor
     : public ImageListener
@@ -92,49 +62,144 @@ public:
 
     Rotation rotation() const
     {
-        return mRotation;
+        return mParams.rotation;
     }
     
     void setRotation(Rotation r)
     {
-        if (mRotation != r) {
-            mRotation = r;
+        // Rotation is applied by the view, the pixmap stays valid
+        mParams.rotation = r;
+    }
+
+    void setFlip(FlipType flip, bool value)
+    {
+        // Flips are applied by the view, the pixmap stays valid
+        mParams.flips[flip] = value;
+    }
+
+    FREE_IMAGE_TMO toneMappingMode() const
+    {
+        return mParams.toneMapping;
+    }
+
+    void setToneMappingMode(FREE_IMAGE_TMO mode)
+    {
+        if(mParams.toneMapping != mode) {
+            mParams.toneMapping = mode;
+            // Parameters of the previous operator have different meaning
+            mParams.toneMappingFirst  = 0.0;
+            mParams.toneMappingSecond = 0.0;
             mIsValid = false;
         }
     }
 
-    void setFlip(FlipType flip, bool value)
+    double toneMappingFirst() const
+    {
+        return mParams.toneMappingFirst;
+    }
+
+    double toneMappingSecond() const
+    {
+        return mParams.toneMappingSecond;
+    }
+
+    /**
+     * Setup operator parameters, see ToneMapping::parameters()
+     */
+    void setToneMappingParams(double first, double second)
     {
-        if (mFlips[flip] != value) {
-            mFlips[flip] = value;
+        if (mParams.toneMappingFirst != first || mParams.toneMappingSecond != second) {
+            mParams.toneMappingFirst  = first;
+            mParams.toneMappingSecond = second;
             mIsValid = false;
         }
     }
 
-    FREE_IMAGE_TMO toneMappingMode() const
+    /**
+     * Setup notification about finished background processing.
+     * Called from the worker thread, the next getResultPixmap() returns the new result or the new mip levels.
+     */
+    void setResultCallback(std::function<void()> onReady)
     {
-        return mToneMapping;
+        mOnResultReady = std::move(onReady);
     }
 
-    void setToneMappingMode(FREE_IMAGE_TMO mode)
+    /**
+     * True if getResultPixmap() returns an outdated result, while the actual one is being computed
+     */
+    bool isResultPending() const
     {
-        if(mToneMapping != mode) {
-            mToneMapping = mode;
+        return !mIsValid;
+    }
+
+    /**
+     * Limits processing to the region of the frame, downsampled to the size.
+     * Region is in the frame pixels with top-down rows, same as getResultPixmap() of the whole frame.
+     * Empty region selects processing of the whole frame in full resolution.
+     */
+    void setViewport(const QRect& region, const QSize& size)
+    {
+        if (mViewport != region || mViewportSize != size) {
+            mViewport = region;
+            mViewportSize = size;
             mIsValid = false;
         }
     }
 
+    QRect viewport() const
+    {
+        return mViewport;
+    }
+
+    QSize viewportSize() const
+    {
+        return mViewportSize;
+    }
+
+    /**
+     * Region of the frame covered by getResultPixmap()
+     */
+    QRect resultRegion() const
+    {
+        return mResultRegion;
+    }
+
+    /**
+     * Fast approximation of the processed frame for interactive changes of parameters.
+     * Only the region is processed, downsampled to the given size. Rotation and flips are not applied.
+     * Doesn't block: the approximation is built in background, meanwhile the last completed one of the frame is returned,
+     * which can cover another region, see previewRegion(). Null until the first one is ready.
+     * @param region Region in getResultPixmap() coordinates
+     */
+    QPixmap getPreviewPixmap(const QRect& region, const QSize& size);
+
+    /**
+     * Region of the frame covered by getPreviewPixmap()
+     */
+    QRect previewRegion() const
+    {
+        return mPreviewResultRegion;
+    }
+
+    /**
+     * Last completed result, doesn't start processing. Can be outdated or null.
+     */
+    const QPixmap& getLastResultPixmap() const
+    {
+        return mDstPixmap;
+    }
+
     void setGamma(double value)
     {
-        if (mGammaValue != value) {
-            mGammaValue = value;
+        if (mParams.gamma != value) {
+            mParams.gamma = value;
             mIsValid = false;
         }
     }
 
     double getGamma() const
     {
-        return mGammaValue;
+        return mParams.gamma;
     }
 
     /**
@@ -142,15 +207,15 @@ public:
      */
     void setChannelSwizzle(ChannelSwizzle swizzle)
     {
-        if (mSwizzleType != swizzle) {
-            mSwizzleType = swizzle;
+        if (mParams.swizzle != swizzle) {
+            mParams.swizzle = swizzle;
             mIsValid = false;
         }
     }
 
     ChannelSwizzle getChannelSwizzle() const
     {
-        return mSwizzleType;
+        return mParams.swizzle;
     }
 
     /**
@@ -159,48 +224,174 @@ public:
     bool getPixel(uint32_t y, uint32_t x, Pixel* p) const;
 
     /**
-     * Image width after processing
+     * Image width after processing, including rotation
      */
     uint32_t width() const;
 
     /**
-     * Image height after processing
+     * Image height after processing, including rotation
      */
     uint32_t height() const;
 
     /**
-     * Processed frame, ready to draw
+     * Processed frame, ready to draw.
+     * Rotation and flips are not applied, the view must transform the pixmap with viewTransform().
+     * Doesn't block: processing runs in background and the last completed result is returned meanwhile, see isResultPending().
      */
     const QPixmap& getResultPixmap();
 
     /**
-     * Processed frame, ready to draw
+     * Processed frame for drawing with the size in device pixels.
+     * Downscaled result is resampled with area averaging in background, meanwhile the nearest level of the mip pyramid,
+     * which is not smaller than required, or getResultPixmap() is returned.
+     * @param resample False while the view is moving, then only the mip pyramid is used
+     */
+    QPixmap getResultPixmap(const QSize& size, bool resample = true);
+
+    /**
+     * Transform from the pixmap rectangle centered at zero to the displayed orientation.
+     * Pixmap is top-down, so the transform is identity without rotation and flips.
+     */
+    QTransform viewTransform() const;
+
+    /**
+     * Duration of the last processing in milliseconds
+     */
+    double processingTime() const
+    {
+        return mProcessingTime;
+    }
+
+    /**
+     * Processed frame with rotation and flips applied, for export
      */
     const UniqueBitmap& getResultBitmap();
 
+    /**
+     * Processed frame with rotation and flips applied, top-down, for export.
+     * Image owns the processed bitmap, no copy is made.
+     */
+    QImage getResultImage();
+
+    /**
+     * Unprocessed source frame, bottom-up, for drawing by the OpenGL canvas. Null if there is no image.
+     */
+    FIBITMAP* getSourceBitmap() const;
+
+    /**
+     * Changes together with the source frame, identifies getSourceBitmap() content
+     */
+    uint64_t sourceGeneration() const
+    {
+        return mGeneration;
+    }
+
 private:
+    void onAboutToInvalidate(Image* emitter) override;
+
     void onInvalidated(Image* emitter) override;
 
-    // Returns handle to FIBITMAP either original or modified
-    FIBITMAP* process(const Image& img);
+    // Returns handle to FIBITMAP either original or modified. Non empty region selects viewport processing.
+    FIBITMAP* process(FIBITMAP* src, const ProcessingParams& params, const QRect& region = QRect(), const QSize& size = QSize());
+
+    // Parameters of the pixmap, rotation and flips are applied by the view
+    ProcessingParams viewParams() const;
+
+    void startJob();
+
+    // Waits for the background job and takes its result if it is still relevant
+    void finishJob(bool takeResult);
+
+    // Preview job is independent of the processing job, so a slow full frame doesn't delay interactive feedback
+    void startPreviewJob(FIBITMAP* bitmap, const QRect& region, const QSize& size);
+
+    void finishPreviewJob(bool takeResult);
+
+    // Returns tone mapped bitmap, reusing the previous result if the source and the operator didn't change
+    FIBITMAP* toneMap(FIBITMAP* src, const ProcessingParams& params);
+
+    void resetToneMapping();
 
 private:
+    struct ProcessingJob
+    {
+        ProcessingParams params;
+        uint64_t generation = 0;
+        QRect viewport;
+        QSize viewportSize;
+        // Viewport clipped by the frame, empty for the whole frame
+        QRect region;
+
+        // Either source bitmap or mProcessBuffer
+        FIBITMAP* result = nullptr;
+        double time = 0.0;
+        std::exception_ptr error;
+
+        std::atomic<bool> ready{ false };
+        // Destructor of the future waits for the worker
+        std::future<void> task;
+    };
+
+    struct PreviewJob
+    {
+        ProcessingParams params;
+        uint64_t generation = 0;
+        // Clipped by the frame
+        QRect region;
+        QSize size;
+
+        std::exception_ptr error;
+
+        std::atomic<bool> ready{ false };
+        std::future<void> task;
+    };
+
+    // Runs in the preview worker, the result is written to mPreviewBuffer
+    void buildPreview(FIBITMAP* bitmap, const PreviewJob& job);
+
     QWeakPointer<Image> mSrcImage;
     UniqueBitmap mProcessBuffer;
+    UniqueBitmap mToneMappingBuffer;
+    UniqueBitmap mViewportBuffer;
+    FIBITMAP* mToneMappingSource = nullptr;
+    FREE_IMAGE_TMO mToneMappingMode = FITMO_CLAMP;
+    double mToneMappingFirst  = 0.0;
+    double mToneMappingSecond = 0.0;
     QPixmap mDstPixmap;
+    QRect mResultRegion;
+
+    QRect mViewport;
+    QSize mViewportSize;
+
+    // Incremented on every change of the source frame
+    uint64_t mGeneration = 0;
+
+    std::function<void()> mOnResultReady;
+    // Buffers and tone mapping cache belong to the job while it is running
+    std::unique_ptr<ProcessingJob> mJob;
+    // Levels of mDstPixmap for zoomed out drawing
+    MipPyramid mPyramid;
+    // mDstPixmap downscaled to the exact displayed size
+    Resampler mResampler;
+
+    // Proxy and buffer belong to the preview job while it is running
+    UniqueBitmap mPreviewSource;
+    QRect mPreviewRegion;
+    QSize mPreviewSize;
+    uint64_t mPreviewGeneration = 0;
+    UniqueBitmap mPreviewBuffer;
+    std::unique_ptr<PreviewJob> mPreviewJob;
+    QPixmap mPreviewPixmap;
+    QRect mPreviewResultRegion;
+    QSize mPreviewResultSize;
+    ProcessingParams mPreviewResultParams;
+    uint64_t mPreviewResultGeneration = 0;
 
     bool mIsValid = false;
-    bool mIsBuffered = false;
-
-    Rotation mRotation = Rotation::eDegree0;
-
-    EnumArray<bool, FlipType> mFlips = { false };
-
-    FREE_IMAGE_TMO mToneMapping = FITMO_CLAMP;
 
-    double mGammaValue = 1.0;
+    ProcessingParams mParams;
 
-    ChannelSwizzle mSwizzleType = ChannelSwizzle::eRGB;
+    double mProcessingTime = 0.0;
 };
 
 #endif // IMAGEPROCESSOR_H
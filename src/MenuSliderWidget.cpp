@@ -0,0 +1,81 @@
+/**
+ * @file
+ *
+ * Copyright 2018-2026 Alexey Gruzdev
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MenuSliderWidget.h"
+
+#include <cmath>
+#include <QSlider>
+#include <QVBoxLayout>
+
+#include "TextWidget.h"
+
+namespace
+{
+    Q_DECL_CONSTEXPR int32_t SLIDER_STEPS = 1000;
+    Q_DECL_CONSTEXPR int32_t SLIDER_MARGIN = 12;
+    Q_DECL_CONSTEXPR int32_t SLIDER_WIDTH = 160;
+}
+
+MenuSliderWidget::MenuSliderWidget(QWidget* parent)
+    : QWidget(parent)
+{
+    mTextWidget = new TextWidget(this, {}, 12, 0.9);
+
+    mSlider = new QSlider(Qt::Horizontal, this);
+    mSlider->setRange(0, SLIDER_STEPS);
+    mSlider->setMinimumWidth(SLIDER_WIDTH);
+    // Only user actions are reported, setup() must stay silent
+    connect(mSlider, &QSlider::sliderPressed,  this, &MenuSliderWidget::pressed);
+    connect(mSlider, &QSlider::sliderMoved,    this, &MenuSliderWidget::onSliderMoved);
+    connect(mSlider, &QSlider::sliderReleased, this, [this]() { emit released(value()); });
+
+    auto layout = new QVBoxLayout();
+    layout->setContentsMargins(SLIDER_MARGIN, 0, SLIDER_MARGIN, SLIDER_MARGIN / 2);
+    layout->setSpacing(0);
+    layout->addWidget(mTextWidget);
+    layout->addWidget(mSlider);
+    setLayout(layout);
+}
+
+MenuSliderWidget::~MenuSliderWidget() = default;
+
+void MenuSliderWidget::setup(const QString& name, double min, double max, double value)
+{
+    mName = name;
+    mMin = min;
+    mMax = max;
+    const QSignalBlocker blocker(mSlider);
+    mSlider->setValue(static_cast<int>(std::lround((value - min) / (max - min) * SLIDER_STEPS)));
+    updateText();
+}
+
+double MenuSliderWidget::value() const
+{
+    return mMin + (mMax - mMin) * mSlider->sliderPosition() / SLIDER_STEPS;
+}
+
+void MenuSliderWidget::onSliderMoved(int /*position*/)
+{
+    updateText();
+    emit moved(value());
+}
+
+void MenuSliderWidget::updateText()
+{
+    mTextWidget->setText(QString("%1: %2").arg(mName).arg(value(), 0, 'f', 2));
+}
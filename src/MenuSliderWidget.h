@@ -0,0 +1,65 @@
+/**
+ * @file
+ *
+ * Copyright 2018-2026 Alexey Gruzdev
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MENUSLIDERWIDGET_H
+#define MENUSLIDERWIDGET_H
+
+#include <QWidget>
+
+class QSlider;
+class TextWidget;
+
+/**
+ * Labeled slider for a continuous parameter inside a context menu
+ */
+class MenuSliderWidget
+    : public QWidget
+{
+    Q_OBJECT
+
+signals:
+    void pressed();
+    void moved(double value);
+    void released(double value);
+
+public:
+    explicit MenuSliderWidget(QWidget* parent = nullptr);
+
+    ~MenuSliderWidget();
+
+    /**
+     * Reconfigure for another parameter, doesn't emit signals
+     */
+    void setup(const QString& name, double min, double max, double value);
+
+    double value() const;
+
+private:
+    void onSliderMoved(int position);
+
+    void updateText();
+
+    QString mName;
+    double mMin = 0.0;
+    double mMax = 1.0;
+
+    QSlider* mSlider;
+    TextWidget* mTextWidget;
+};
+
+#endif // MENUSLIDERWIDGET_H
@@ -0,0 +1,151 @@
+/**
+ * @file
+ *
+ * Copyright 2018-2026 Alexey Gruzdev
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MipPyramid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "Parallel.h"
+#include "Resampler.h"
+
+namespace
+{
+    // Levels below this size are not worth building
+    constexpr int kMinLevelSize = 16;
+
+    template <uint32_t Channels_>
+    void halveRows(const QImage& src, uchar* dstBits, size_t dstPitch, uint32_t dstWidth, uint32_t begin, uint32_t end)
+    {
+        const uint32_t srcWidth  = static_cast<uint32_t>(src.width());
+        const uint32_t srcHeight = static_cast<uint32_t>(src.height());
+        const uint32_t pairs = srcWidth / 2;
+        for (uint32_t y = begin; y < end; ++y) {
+            const uchar* row0 = src.constScanLine(static_cast<int>(2 * y));
+            const uchar* row1 = src.constScanLine(static_cast<int>(std::min(2 * y + 1, srcHeight - 1)));
+            uchar* dst = dstBits + y * dstPitch;
+            for (uint32_t x = 0; x < pairs; ++x) {
+                const uchar* p0 = row0 + 2 * x * Channels_;
+                const uchar* p1 = row1 + 2 * x * Channels_;
+                for (uint32_t c = 0; c < Channels_; ++c) {
+                    dst[x * Channels_ + c] = static_cast<uchar>((p0[c] + p0[c + Channels_] + p1[c] + p1[c + Channels_] + 2) >> 2);
+                }
+            }
+            if (pairs < dstWidth) {
+                // Odd width, the last column is averaged vertically only
+                const uchar* p0 = row0 + 2 * pairs * Channels_;
+                const uchar* p1 = row1 + 2 * pairs * Channels_;
+                for (uint32_t c = 0; c < Channels_; ++c) {
+                    dst[pairs * Channels_ + c] = static_cast<uchar>((p0[c] + p1[c] + 1) >> 1);
+                }
+            }
+        }
+    }
+
+    QImage halve(const QImage& src)
+    {
+        QImage dst((src.width() + 1) / 2, (src.height() + 1) / 2, src.format());
+        if (dst.isNull()) {
+            throw std::runtime_error("MipPyramid[halve]: Failed to allocate level.");
+        }
+        // Non-const access detaches, so it must be done before the parallel part
+        uchar* dstBits = dst.bits();
+        const size_t dstPitch = static_cast<size_t>(dst.bytesPerLine());
+        const uint32_t dstWidth  = static_cast<uint32_t>(dst.width());
+        const uint32_t channels  = static_cast<uint32_t>(src.depth() / 8);
+        parallelFor(static_cast<uint32_t>(dst.height()), 4 * dstWidth * channels, [&](uint32_t begin, uint32_t end) {
+            switch (channels) {
+            case 1:
+                halveRows<1>(src, dstBits, dstPitch, dstWidth, begin, end);
+                break;
+            case 3:
+                halveRows<3>(src, dstBits, dstPitch, dstWidth, begin, end);
+                break;
+            case 4:
+                halveRows<4>(src, dstBits, dstPitch, dstWidth, begin, end);
+                break;
+            default:
+                throw std::logic_error("MipPyramid[halve]: Unsupported format.");
+            }
+        });
+        return dst;
+    }
+}
+
+MipPyramid::~MipPyramid()
+{
+    reset();
+}
+
+void MipPyramid::build(qint64 key, QImage image, std::function<void()> onReady)
+{
+    reset();
+    auto state = std::make_unique<State>();
+    state->key = key;
+    State* pState = state.get();
+    state->task = std::async(std::launch::async, [pState, image = std::move(image), onReady = std::move(onReady)]() {
+        try {
+            QImage current = Resampler::toFilterableFormat(image);
+            while (!pState->cancelled && std::max(current.width(), current.height()) > kMinLevelSize) {
+                current = halve(current);
+                pState->levels.push_back(current);
+            }
+        }
+        catch (...) {
+            // Full resolution image is drawn instead
+            return;
+        }
+        if (!pState->cancelled) {
+            pState->ready = true;
+            if (onReady) {
+                onReady();
+            }
+        }
+    });
+    mState = std::move(state);
+}
+
+void MipPyramid::reset()
+{
+    if (mState) {
+        mState->cancelled = true;
+        mState.reset();
+    }
+    mPixmaps.clear();
+}
+
+QPixmap MipPyramid::level(qreal scale)
+{
+    if (!mState || !mState->ready || !(scale > 0.0)) {
+        return QPixmap();
+    }
+    const auto& levels = mState->levels;
+    const int index = std::min(static_cast<int>(std::floor(std::log2(1.0 / scale))), static_cast<int>(levels.size())) - 1;
+    if (index < 0) {
+        return QPixmap();
+    }
+    if (mPixmaps.empty()) {
+        mPixmaps.resize(levels.size());
+    }
+    auto& pixmap = mPixmaps[index];
+    if (pixmap.isNull()) {
+        pixmap = QPixmap::fromImage(levels[index]);
+    }
+    return pixmap;
+}
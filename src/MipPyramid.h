@@ -0,0 +1,92 @@
+/**
+ * @file
+ *
+ * Copyright 2018-2026 Alexey Gruzdev
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MIPPYRAMID_H
+#define MIPPYRAMID_H
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include <QImage>
+#include <QPixmap>
+
+/**
+ * Box filtered levels of an image, each one is half of the previous.
+ * Levels are built in background, pixmaps are created on demand in the GUI thread.
+ */
+class MipPyramid
+{
+public:
+    MipPyramid() = default;
+
+    MipPyramid(const MipPyramid&) = delete;
+
+    MipPyramid(MipPyramid&&) = delete;
+
+    ~MipPyramid();
+
+    MipPyramid& operator=(const MipPyramid&) = delete;
+
+    MipPyramid& operator=(MipPyramid&&) = delete;
+
+    /**
+     * Starts building levels of the image in background, the previous levels are dropped.
+     * @param key Identifies the image, see isBuiltFor()
+     * @param onReady Called from the worker thread when all levels are ready
+     */
+    void build(qint64 key, QImage image, std::function<void()> onReady);
+
+    /**
+     * Stops building and drops all levels
+     */
+    void reset();
+
+    /**
+     * True if the last build() was called for the key, even if levels are not ready yet
+     */
+    bool isBuiltFor(qint64 key) const
+    {
+        return mState && mState->key == key;
+    }
+
+    /**
+     * Returns the smallest level which is not smaller than the image scaled by the factor.
+     * Null pixmap is returned if the full image should be used or levels are not ready yet.
+     */
+    QPixmap level(qreal scale);
+
+private:
+    struct State
+    {
+        qint64 key = 0;
+        // Level i is downscaled 2^(i + 1) times
+        std::vector<QImage> levels;
+        std::atomic<bool> ready{ false };
+        std::atomic<bool> cancelled{ false };
+        // Destructor of the future waits for the worker
+        std::future<void> task;
+    };
+
+    std::unique_ptr<State> mState;
+    std::vector<QPixmap> mPixmaps;
+};
+
+#endif // MIPPYRAMID_H
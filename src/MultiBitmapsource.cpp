@@ -52,7 +52,12 @@ uint32_t MultibitmapSource::doPagesCount() const
 
 const ImagePage* MultibitmapSource::doDecodePage(uint32_t pageIdx)
 {
-    auto page = std::make_unique<ImagePage>(FreeImage_LockPage(mMultibitmap, static_cast<int>(pageIdx)), pageIdx);
+    FIBITMAP* bmp = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(mMultibitmapMutex);
+        bmp = FreeImage_LockPage(mMultibitmap, static_cast<int>(pageIdx));
+    }
+    auto page = std::make_unique<ImagePage>(bmp, pageIdx);
     AnimationInfo anim{};
     if (auto bmp = page->getSourceBitmap()) {
         anim.offsetX = FreeImageExt_GetMetadataValue<uint16_t>(FIMD_ANIMATION, bmp, "FrameLeft", 0);
@@ -67,6 +72,7 @@ const ImagePage* MultibitmapSource::doDecodePage(uint32_t pageIdx)
 void MultibitmapSource::doReleasePage(const ImagePage* page)
 {
     if (page) {
+        std::unique_lock<std::mutex> lock(mMultibitmapMutex);
         FreeImage_UnlockPage(mMultibitmap, page->getSourceBitmap(), false);
     }
     delete page;
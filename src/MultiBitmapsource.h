@@ -19,6 +19,7 @@
 #ifndef MULTIBITMAPSOURCE_H
 #define MULTIBITMAPSOURCE_H
 
+#include <mutex>
 #include "ImageSource.h"
 #include <QString>
 
@@ -53,6 +54,9 @@ private:
 
     FREE_IMAGE_FORMAT mImageFormat;
     FIMULTIBITMAP* mMultibitmap = nullptr;
+
+    // Pages can be decoded from a background thread
+    std::mutex mMultibitmapMutex;
 };
 
 #endif // MULTIBITMAPSOURCE_H
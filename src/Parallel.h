@@ -0,0 +1,78 @@
+/**
+ * @file
+ *
+ * Copyright 2018-2026 Alexey Gruzdev
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <cstdint>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace details
+{
+    // Minimal amount of work worth a separate task, in processed elements
+    constexpr uint64_t kMinTaskCost = 64 * 1024;
+}
+
+/**
+ * Splits range [0, count) into continuous chunks and runs body(begin, end) for them in parallel.
+ * Small ranges are processed in the calling thread.
+ */
+template <typename Body_>
+void parallelFor(uint32_t count, uint64_t costPerItem, Body_&& body)
+{
+    const uint64_t totalCost = static_cast<uint64_t>(count) * std::max<uint64_t>(costPerItem, 1);
+    const uint32_t maxTasks  = std::min(std::max(std::thread::hardware_concurrency(), 1u), count);
+    const uint32_t tasksNum  = static_cast<uint32_t>(std::clamp<uint64_t>(totalCost / details::kMinTaskCost, 1, std::max(maxTasks, 1u)));
+    if (tasksNum <= 1) {
+        body(0u, count);
+        return;
+    }
+    const uint32_t chunk = (count + tasksNum - 1) / tasksNum;
+    std::vector<std::future<void>> tasks;
+    tasks.reserve(tasksNum - 1);
+    for (uint32_t begin = chunk; begin < count; begin += chunk) {
+        const uint32_t end = std::min(begin + chunk, count);
+        tasks.push_back(std::async(std::launch::async, [&body, begin, end]() { body(begin, end); }));
+    }
+    body(0u, std::min(chunk, count));
+    for (auto& task : tasks) {
+        task.get();
+    }
+}
+
+/**
+ * Reduces range [0, count) in parallel.
+ * body(begin, end) returns result for a chunk, results of chunks are combined with op(lhs, rhs) in arbitrary order.
+ */
+template <typename Ty_, typename Body_, typename Op_>
+Ty_ parallelReduce(uint32_t count, uint64_t costPerItem, Ty_ init, Body_&& body, Op_&& op)
+{
+    std::mutex mutex;
+    parallelFor(count, costPerItem, [&](uint32_t begin, uint32_t end) {
+        Ty_ partial = body(begin, end);
+        std::lock_guard<std::mutex> lock(mutex);
+        init = op(init, partial);
+    });
+    return init;
+}
+
+#endif // PARALLEL_H
@@ -0,0 +1,67 @@
+/**
+ * @file
+ *
+ * Copyright 2018-2026 Alexey Gruzdev
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PerformanceStats.h"
+
+namespace
+{
+    inline
+    QString toMs(double t)
+    {
+        return QString::number(t, 'f', 2) + QString(" ms");
+    }
+
+    inline
+    QString toFps(double ms)
+    {
+        return (ms > 0.0) ? QString::number(1000.0 / ms, 'f', 1) : QString("-");
+    }
+}
+
+QVector<QString> PerformanceStats::toLines() const
+{
+    QVector<QString> res;
+    if (mNominalDuration > 0) {
+        res.push_back("FPS: " + toFps(mFrameInterval) + " / " + toFps(mNominalDuration));
+    }
+    res.push_back("Decode: " + toMs(mPlayback.decodeTime));
+    if (mPlayback.compositeTime > 0.0) {
+        res.push_back("Composite: " + toMs(mPlayback.compositeTime));
+    }
+    res.push_back("Process: " + toMs(mProcessingTime));
+    res.push_back("Paint: " + toMs(mPaintTime));
+    res.push_back("");
+
+    const uint64_t accesses = mPlayback.cacheHits + mPlayback.cacheMisses;
+    if (accesses > 0) {
+        res.push_back(QString("Cache hits: %1% (%2/%3)").arg(QString::number(100.0 * mPlayback.cacheHits / accesses, 'f', 1)).arg(mPlayback.cacheHits).arg(accesses));
+    }
+    else {
+        res.push_back("Cache hits: -");
+    }
+    res.push_back(QString("Cache size: %1/%2 frames, ").arg(mPlayback.cacheLength).arg(mPlayback.cacheCapacity) + QString::number(mPlayback.cacheBytes / (1024.0 * 1024.0), 'f', 1) + "MB");
+    if (mPlayback.prefetchHits > 0) {
+        res.push_back(QString("Prefetched: %1").arg(mPlayback.prefetchHits));
+    }
+    if (mPlayback.checkpoints > 0) {
+        res.push_back(QString("Checkpoints: %1").arg(mPlayback.checkpoints));
+    }
+
+    return res;
+}
+
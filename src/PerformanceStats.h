@@ -0,0 +1,83 @@
+/**
+ * @file
+ *
+ * Copyright 2018-2026 Alexey Gruzdev
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PERFORMANCESTATS_H
+#define PERFORMANCESTATS_H
+
+#include <QVector>
+#include <QString>
+
+#include "Player.h"
+
+class PerformanceStats
+{
+public:
+    PerformanceStats()
+    { }
+
+    void reset()
+    {
+        *this = PerformanceStats{};
+    }
+
+    void setPlaybackStats(PlaybackStats stats)
+    {
+        mPlayback = std::move(stats);
+    }
+
+    void setProcessingTime(double ms)
+    {
+        mProcessingTime = ms;
+    }
+
+    void addPaintTime(double ms)
+    {
+        accumulate(mPaintTime, ms);
+    }
+
+    /**
+     * Time between two consecutive animation frames on the screen
+     */
+    void addFrameInterval(double ms)
+    {
+        accumulate(mFrameInterval, ms);
+    }
+
+    void setNominalFrameDuration(uint32_t ms)
+    {
+        mNominalDuration = ms;
+    }
+
+    QVector<QString> toLines() const;
+
+private:
+    static constexpr double kSmoothing = 0.1;
+
+    static void accumulate(double& avg, double value)
+    {
+        avg = (avg > 0.0) ? avg + kSmoothing * (value - avg) : value;
+    }
+
+    PlaybackStats mPlayback;
+    double mProcessingTime = 0.0;
+    double mPaintTime = 0.0;
+    double mFrameInterval = 0.0;
+    uint32_t mNominalDuration = 0;
+};
+
+#endif // PERFORMANCESTATS_H
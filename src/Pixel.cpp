@@ -17,6 +17,8 @@
  */
 
 #include "Pixel.h"
+#include "FreeImageExt.h"
+#include "RowKernels.h"
 
 bool Pixel::getBitmapPixel(FIBITMAP* src, uint32_t y, uint32_t x, Pixel* pixel)
 {
@@ -29,6 +31,23 @@ bool Pixel::getBitmapPixel(FIBITMAP* src, uint32_t y, uint32_t x, Pixel* pixel)
     bool success = true;
     const uint32_t bpp = FreeImage_GetBPP(src);
     const uint8_t* rawPixel = FreeImage_GetScanLine(src, static_cast<int>(y)) + x * bpp / 8;
+    if (FreeImageExt_IsHalf(src)) {
+        float values[4] = {};
+        RowKernels::halfToFloat(static_cast<const uint16_t*>(static_cast<const void*>(rawPixel)), values, bpp / 16);
+        const uint8_t* rawValues = static_cast<const uint8_t*>(static_cast<const void*>(values));
+        switch (bpp) {
+        case 64:
+            pixel->repr = pixelToString4<FIRGBAF>(rawValues);
+            break;
+        case 48:
+            pixel->repr = pixelToString3<FIRGBF>(rawValues);
+            break;
+        default:
+            pixel->repr = pixelToString1<float>(rawValues);
+            break;
+        }
+        return true;
+    }
     switch (FreeImage_GetImageType(src)) {
     case FIT_RGBAF:
         pixel->repr = pixelToString4<FIRGBAF>(rawPixel);
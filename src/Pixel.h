@@ -19,6 +19,11 @@
 #ifndef PIXEL_H
 #define PIXEL_H
 
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <type_traits>
+
 #include "FreeImage.h"
 #include <QString>
 
@@ -33,25 +38,58 @@ struct Pixel
 };
 
 
-template <typename Ty_>
-inline
-QString numberToQString(Ty_ v)
+namespace details
 {
-    return QString::number(v);
-}
+    // Enough for four doubles
+    constexpr size_t kPixelTextCapacity = 128;
 
-template <>
-inline
-QString numberToQString<float>(float v)
-{
-    return QString::number(v, 'g', 4);
-}
+    inline
+    int formatNumber(char* dst, size_t size, float v)
+    {
+        return std::snprintf(dst, size, "%.4g", v);
+    }
 
-template <>
-inline
-QString numberToQString<double>(double v)
-{
-    return QString::number(v, 'g', 6);
+    inline
+    int formatNumber(char* dst, size_t size, double v)
+    {
+        return std::snprintf(dst, size, "%.6g", v);
+    }
+
+    template <typename Ty_>
+    inline
+    int formatNumber(char* dst, size_t size, Ty_ v)
+    {
+        static_assert(std::is_integral_v<Ty_>, "Unexpected channel type");
+        if constexpr (std::is_signed_v<Ty_>) {
+            return std::snprintf(dst, size, "%lld", static_cast<long long>(v));
+        }
+        else {
+            return std::snprintf(dst, size, "%llu", static_cast<unsigned long long>(v));
+        }
+    }
+
+    /**
+     * Comma separated values formatted in a stack buffer, without intermediate strings
+     */
+    template <typename... Ty_>
+    inline
+    QString formatValues(Ty_... values)
+    {
+        std::array<char, kPixelTextCapacity> buffer;
+        size_t length = 0;
+        const auto append = [&](auto v) {
+            if (length != 0 && length + 2 < buffer.size()) {
+                buffer[length++] = ',';
+                buffer[length++] = ' ';
+            }
+            const int n = formatNumber(buffer.data() + length, buffer.size() - length, v);
+            if (n > 0) {
+                length = std::min(length + static_cast<size_t>(n), buffer.size() - 1);
+            }
+        };
+        (append(values), ...);
+        return QString::fromLatin1(buffer.data(), static_cast<int>(length));
+    }
 }
 
 
@@ -60,7 +98,7 @@ inline
 QString pixelToString4(const uint8_t* raw)
 {
     const auto p = static_cast<const PTy_*>(static_cast<const void*>(raw));
-    return QString("%1, %2, %3, %4").arg(numberToQString(p->red)).arg(numberToQString(p->green)).arg(numberToQString(p->blue)).arg(numberToQString(p->alpha));
+    return details::formatValues(p->red, p->green, p->blue, p->alpha);
 }
 
 template <typename PTy_>
@@ -68,7 +106,7 @@ inline
 QString pixelToString3(const uint8_t* raw)
 {
     const auto p = static_cast<const PTy_*>(static_cast<const void*>(raw));
-    return QString("%1, %2, %3").arg(numberToQString(p->red)).arg(numberToQString(p->green)).arg(numberToQString(p->blue));
+    return details::formatValues(p->red, p->green, p->blue);
 }
 
 template <typename PTy_>
@@ -76,7 +114,7 @@ inline
 QString pixelToString2(const uint8_t* raw)
 {
     const auto p = static_cast<const PTy_*>(static_cast<const void*>(raw));
-    return QString("%1, %2").arg(numberToQString(p->r)).arg(numberToQString(p->i));
+    return details::formatValues(p->r, p->i);
 }
 
 template <typename PTy_>
@@ -84,7 +122,7 @@ inline
 QString pixelToString1(const uint8_t* raw)
 {
     const auto p = static_cast<const PTy_*>(static_cast<const void*>(raw));
-    return numberToQString(*p);
+    return details::formatValues(*p);
 }
 
 #endif // PIXEL_H
@@ -0,0 +1,387 @@
+/**
+ * @file
+ *
+ * Copyright 2018-2026 Alexey Gruzdev
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PIXELTRAITS_H
+#define PIXELTRAITS_H
+
+#include <cstdint>
+#include <type_traits>
+
+#include "FreeImageExt.h"
+#include "RowKernels.h"
+
+/**
+ * Pixel layouts of bitmaps which can be displayed
+ */
+enum class PixelFormat
+    : uint8_t
+{
+    eUnknown,
+    eBit,
+    eGray8,
+    eRGB8,
+    eRGBA8,
+    eGray16,
+    eRGB16,
+    eRGBA16,
+    eGrayHalf,
+    eRGBHalf,
+    eRGBAHalf,
+    eGrayFloat,
+    eGrayDouble,
+    eRGBFloat,
+    eRGBAFloat
+};
+
+/**
+ * Classifies the bitmap, so that it is done once and not per pixel
+ */
+inline
+PixelFormat pixelFormat(FIBITMAP* bmp)
+{
+    if (!bmp) {
+        return PixelFormat::eUnknown;
+    }
+    const bool half = FreeImageExt_IsHalf(bmp);
+    switch (FreeImage_GetImageType(bmp)) {
+    case FIT_BITMAP:
+        switch (FreeImage_GetBPP(bmp)) {
+        case 1:
+            return PixelFormat::eBit;
+        case 8:
+            return PixelFormat::eGray8;
+        case 24:
+            return PixelFormat::eRGB8;
+        case 32:
+            return PixelFormat::eRGBA8;
+        default:
+            return PixelFormat::eUnknown;
+        }
+    case FIT_UINT16:
+        return half ? PixelFormat::eGrayHalf : PixelFormat::eGray16;
+    case FIT_RGB16:
+        return half ? PixelFormat::eRGBHalf : PixelFormat::eRGB16;
+    case FIT_RGBA16:
+        return half ? PixelFormat::eRGBAHalf : PixelFormat::eRGBA16;
+    case FIT_FLOAT:
+        return PixelFormat::eGrayFloat;
+    case FIT_DOUBLE:
+        return PixelFormat::eGrayDouble;
+    case FIT_RGBF:
+        return PixelFormat::eRGBFloat;
+    case FIT_RGBAF:
+        return PixelFormat::eRGBAFloat;
+    default:
+        return PixelFormat::eUnknown;
+    }
+}
+
+
+namespace details
+{
+    // Conversions of stored values to values of channels
+
+    struct ByteValue
+    {
+        using Value = uint8_t;
+        static constexpr bool kFloatingPoint = false;
+
+        static Value get(uint8_t v)
+        {
+            return v;
+        }
+
+        static Value opaque()
+        {
+            return 255;
+        }
+    };
+
+    struct NormalizedValue
+    {
+        using Value = float;
+        static constexpr bool kFloatingPoint = false;
+
+        static Value get(uint16_t v)
+        {
+            return static_cast<float>(v) * (1.0f / 65535.0f);
+        }
+
+        static Value opaque()
+        {
+            return 1.0f;
+        }
+    };
+
+    struct HalfValue
+    {
+        using Value = float;
+        static constexpr bool kFloatingPoint = true;
+
+        static Value get(uint16_t v)
+        {
+            return RowKernels::halfToFloat(v);
+        }
+
+        static Value opaque()
+        {
+            return 1.0f;
+        }
+    };
+
+    struct RealValue
+    {
+        using Value = float;
+        static constexpr bool kFloatingPoint = true;
+
+        template <typename Ty_>
+        static Value get(Ty_ v)
+        {
+            return static_cast<float>(v);
+        }
+
+        static Value opaque()
+        {
+            return 1.0f;
+        }
+    };
+
+
+    template <typename Stored_, typename Convert_>
+    struct GrayTraits
+    {
+        using Value = typename Convert_::Value;
+        static constexpr uint32_t kChannels = 1;
+        static constexpr bool kFloatingPoint = Convert_::kFloatingPoint;
+
+        static Value red(const uint8_t* line, int64_t x)
+        {
+            return Convert_::get(reinterpret_cast<const Stored_*>(line)[x]);
+        }
+
+        static Value green(const uint8_t* line, int64_t x)
+        {
+            return red(line, x);
+        }
+
+        static Value blue(const uint8_t* line, int64_t x)
+        {
+            return red(line, x);
+        }
+
+        static Value alpha(const uint8_t*, int64_t)
+        {
+            return Convert_::opaque();
+        }
+    };
+
+    template <typename Pixel_, typename Convert_, bool HasAlpha_>
+    struct ColorTraits
+    {
+        using Value = typename Convert_::Value;
+        static constexpr uint32_t kChannels = HasAlpha_ ? 4 : 3;
+        static constexpr bool kFloatingPoint = Convert_::kFloatingPoint;
+
+        static Value red(const uint8_t* line, int64_t x)
+        {
+            return Convert_::get(reinterpret_cast<const Pixel_*>(line)[x].red);
+        }
+
+        static Value green(const uint8_t* line, int64_t x)
+        {
+            return Convert_::get(reinterpret_cast<const Pixel_*>(line)[x].green);
+        }
+
+        static Value blue(const uint8_t* line, int64_t x)
+        {
+            return Convert_::get(reinterpret_cast<const Pixel_*>(line)[x].blue);
+        }
+
+        static Value alpha(const uint8_t* line, int64_t x)
+        {
+            return alphaImpl(line, x, std::integral_constant<bool, HasAlpha_>{});
+        }
+
+    private:
+        static Value alphaImpl(const uint8_t* line, int64_t x, std::true_type)
+        {
+            return Convert_::get(reinterpret_cast<const Pixel_*>(line)[x].alpha);
+        }
+
+        static Value alphaImpl(const uint8_t*, int64_t, std::false_type)
+        {
+            return Convert_::opaque();
+        }
+    };
+}
+
+
+/**
+ * Compile time access to pixels of the format.
+ * Value is uint8_t for 8 bit formats, other formats are read as float, 16 bit integers are normalized.
+ * Floating point formats may have values outside of [0, 1] and need tone mapping.
+ */
+template <PixelFormat Format_>
+struct PixelTraits;
+
+template <>
+struct PixelTraits<PixelFormat::eBit>
+{
+    using Value = uint8_t;
+    static constexpr uint32_t kChannels = 1;
+    static constexpr bool kFloatingPoint = false;
+
+    static Value red(const uint8_t* line, int64_t x)
+    {
+        return (line[x >> 3] & (0x80 >> (x & 0x7))) ? 255 : 0;
+    }
+
+    static Value green(const uint8_t* line, int64_t x)
+    {
+        return red(line, x);
+    }
+
+    static Value blue(const uint8_t* line, int64_t x)
+    {
+        return red(line, x);
+    }
+
+    static Value alpha(const uint8_t*, int64_t)
+    {
+        return 255;
+    }
+};
+
+template <>
+struct PixelTraits<PixelFormat::eGray8> : details::GrayTraits<uint8_t, details::ByteValue> { };
+
+template <>
+struct PixelTraits<PixelFormat::eRGB8> : details::ColorTraits<FIRGB8, details::ByteValue, false> { };
+
+template <>
+struct PixelTraits<PixelFormat::eRGBA8> : details::ColorTraits<FIRGBA8, details::ByteValue, true> { };
+
+template <>
+struct PixelTraits<PixelFormat::eGray16> : details::GrayTraits<uint16_t, details::NormalizedValue> { };
+
+template <>
+struct PixelTraits<PixelFormat::eRGB16> : details::ColorTraits<FIRGB16, details::NormalizedValue, false> { };
+
+template <>
+struct PixelTraits<PixelFormat::eRGBA16> : details::ColorTraits<FIRGBA16, details::NormalizedValue, true> { };
+
+template <>
+struct PixelTraits<PixelFormat::eGrayHalf> : details::GrayTraits<uint16_t, details::HalfValue> { };
+
+template <>
+struct PixelTraits<PixelFormat::eRGBHalf> : details::ColorTraits<FIRGB16, details::HalfValue, false> { };
+
+template <>
+struct PixelTraits<PixelFormat::eRGBAHalf> : details::ColorTraits<FIRGBA16, details::HalfValue, true> { };
+
+template <>
+struct PixelTraits<PixelFormat::eGrayFloat> : details::GrayTraits<float, details::RealValue> { };
+
+template <>
+struct PixelTraits<PixelFormat::eGrayDouble> : details::GrayTraits<double, details::RealValue> { };
+
+template <>
+struct PixelTraits<PixelFormat::eRGBFloat> : details::ColorTraits<FIRGBF, details::RealValue, false> { };
+
+template <>
+struct PixelTraits<PixelFormat::eRGBAFloat> : details::ColorTraits<FIRGBAF, details::RealValue, true> { };
+
+
+/**
+ * Calls visitor(PixelTraits<format>{}) once, so the visitor is compiled for every format and has no switches inside.
+ * Returns false if the format is unknown.
+ */
+template <typename Visitor_>
+bool visitPixels(PixelFormat format, Visitor_&& visitor)
+{
+    switch (format) {
+    case PixelFormat::eBit:
+        visitor(PixelTraits<PixelFormat::eBit>{});
+        return true;
+    case PixelFormat::eGray8:
+        visitor(PixelTraits<PixelFormat::eGray8>{});
+        return true;
+    case PixelFormat::eRGB8:
+        visitor(PixelTraits<PixelFormat::eRGB8>{});
+        return true;
+    case PixelFormat::eRGBA8:
+        visitor(PixelTraits<PixelFormat::eRGBA8>{});
+        return true;
+    case PixelFormat::eGray16:
+        visitor(PixelTraits<PixelFormat::eGray16>{});
+        return true;
+    case PixelFormat::eRGB16:
+        visitor(PixelTraits<PixelFormat::eRGB16>{});
+        return true;
+    case PixelFormat::eRGBA16:
+        visitor(PixelTraits<PixelFormat::eRGBA16>{});
+        return true;
+    case PixelFormat::eGrayHalf:
+        visitor(PixelTraits<PixelFormat::eGrayHalf>{});
+        return true;
+    case PixelFormat::eRGBHalf:
+        visitor(PixelTraits<PixelFormat::eRGBHalf>{});
+        return true;
+    case PixelFormat::eRGBAHalf:
+        visitor(PixelTraits<PixelFormat::eRGBAHalf>{});
+        return true;
+    case PixelFormat::eGrayFloat:
+        visitor(PixelTraits<PixelFormat::eGrayFloat>{});
+        return true;
+    case PixelFormat::eGrayDouble:
+        visitor(PixelTraits<PixelFormat::eGrayDouble>{});
+        return true;
+    case PixelFormat::eRGBFloat:
+        visitor(PixelTraits<PixelFormat::eRGBFloat>{});
+        return true;
+    case PixelFormat::eRGBAFloat:
+        visitor(PixelTraits<PixelFormat::eRGBAFloat>{});
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * Number of channels, 0 for unknown format
+ */
+inline
+uint32_t pixelChannels(PixelFormat format)
+{
+    uint32_t channels = 0;
+    visitPixels(format, [&](auto traits) { channels = decltype(traits)::kChannels; });
+    return channels;
+}
+
+/**
+ * Returns true if values are not limited to [0, 1]
+ */
+inline
+bool isFloatingPoint(PixelFormat format)
+{
+    bool floatingPoint = false;
+    visitPixels(format, [&](auto traits) { floatingPoint = decltype(traits)::kFloatingPoint; });
+    return floatingPoint;
+}
+
+#endif // PIXELTRAITS_H
@@ -18,7 +18,9 @@
 
 #include "Player.h"
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <stdexcept>
 #include <vector>
 
@@ -31,6 +33,27 @@ namespace
 {
     constexpr size_t kMaxCacheBytes  = 256 * 1024 * 1024;
     constexpr size_t kMaxCacheLength = 100;
+
+    // Part of the budget available for checkpoints
+    constexpr size_t kMaxCheckpointsBytes = kMaxCacheBytes / 4;
+
+    // Cache length allowing to prefetch two pages in each direction
+    constexpr size_t kMinCacheForFarPrefetch = 5;
+
+    // Adjacent pages are prefetched even if the cache budget is used up
+    constexpr uint32_t kNearPrefetchDistance = 1;
+
+    constexpr double kStatsSmoothing = 0.1;
+
+    double elapsedMs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void accumulate(double& avg, double value)
+    {
+        avg = (avg > 0.0) ? avg + kStatsSmoothing * (value - avg) : value;
+    }
 }
 
 
@@ -38,6 +61,8 @@ struct Player::CacheEntry
 {
     ImageSource::ImagePagePtr page;
     UniqueBitmap blendedImage;
+    size_t bytes = 0;
+    double decodeTime = 0.0;
 
     CacheEntry(ImageSource::ImagePagePtr page)
         : page(std::move(page))
@@ -52,10 +77,12 @@ Player::Player(std::shared_ptr<ImageSource> src)
     if (!src) {
         throw std::runtime_error("Player[Player]: Image source is null.");
     }
+    mSource = std::move(src);
 
-    const auto framesNum = src->pagesCount();
+    const auto framesNum = mSource->pagesCount();
     if (framesNum > 0) {
-        mFramesCache.emplace_back(loadZeroFrame(src.get()));
+        mFramesCache.emplace_back(loadZeroFrame(mSource.get()));
+        mCacheBytes = mFramesCache[0]->bytes;
 
         //if (auto bmp = mFramesCache[0]->page->getSourceBitmap()) {
         //    if (FreeImage_HasBackgroundColor(bmp)) {
@@ -64,28 +91,57 @@ Player::Player(std::shared_ptr<ImageSource> src)
         //    }
         //}
 
-        const size_t frameSize = mFramesCache[0]->page->getMemorySize();
-        if (frameSize > 0) {
-            const size_t maxLenth = std::min<size_t>(framesNum, kMaxCacheLength);
-            mMaxCacheSize = std::clamp(kMaxCacheBytes / frameSize, static_cast<size_t>(1), maxLenth);
-        }
+        schedulePrefetch();
     }
-
-    mSource = std::move(src);
 }
 
 Player::~Player()
 {
+    // Waits for workers
+    mPrefetched.clear();
+
     mFramesCache.clear();
+    mCheckpoints.clear();
     mSource.reset();
 }
 
+std::unique_ptr<Player::CacheEntry> Player::decodeFrame(std::shared_ptr<ImageSource> source, uint32_t idx)
+{
+    const auto decodeStart = std::chrono::steady_clock::now();
+    auto entry = std::make_unique<CacheEntry>(source->lockPage(idx));
+    if (!entry->page) {
+        throw std::runtime_error("Player[decodeFrame]: Failed to decode a page.");
+    }
+    entry->decodeTime = elapsedMs(decodeStart);
+    entry->bytes = entry->page->getMemorySize();
+    return entry;
+}
+
+std::unique_ptr<Player::CacheEntry> Player::loadFrame(ImageSource* source, uint32_t idx)
+{
+    std::unique_ptr<CacheEntry> entry = nullptr;
+    const auto it = mPrefetched.find(idx);
+    if (it != mPrefetched.end()) {
+        // Page is locked by the worker, so must be taken from there
+        auto task = std::move(it->second);
+        mPrefetched.erase(it);
+        entry = task.get();
+        ++mStats.prefetchHits;
+    }
+    else {
+        entry = decodeFrame(source->shared_from_this(), idx);
+    }
+    accumulate(mStats.decodeTime, entry->decodeTime);
+    return entry;
+}
+
 std::unique_ptr<Player::CacheEntry> Player::loadZeroFrame(ImageSource* source)
 {
-    auto entry = std::make_unique<CacheEntry>(source->lockPage(0));
-    if (!entry->page || entry->page->isEmpty()) {
+    auto entry = loadFrame(source, 0);
+    if (entry->page->isEmpty()) {
         throw std::runtime_error("Player[loadZeroFrame]: Failed to decode zero page.");
     }
+    updateCacheLimits(*entry);
     return entry;
 }
 
@@ -97,13 +153,11 @@ std::unique_ptr<Player::CacheEntry> Player::loadNextFrame(ImageSource* source, c
     const uint32_t nextIdx = (prevIdx + 1) % mSource->pagesCount();
 
     const auto disposal = prev.page->animation().disposal;
-    auto nextEntry = std::make_unique<CacheEntry>(source->lockPage(nextIdx));
-    if (!nextEntry->page) {
-        throw std::runtime_error("Player[loadNextFrame]: Failed to decode the next page.");
-    }
+    auto nextEntry = loadFrame(source, nextIdx);
     FIBITMAP* nextBmp = nextEntry->page->getBitmap();
 
     if (source->storesDifference()) {
+        const auto compositeStart = std::chrono::steady_clock::now();
         const auto& nextAnim = nextEntry->page->animation();
 
         UniqueBitmap canvas(nullptr, &::FreeImage_Unload);
@@ -125,13 +179,147 @@ std::unique_ptr<Player::CacheEntry> Player::loadNextFrame(ImageSource* source, c
             if (FreeImage_DrawBitmap(canvas.get(), nextBmp, FIAO_SrcAlpha, nextAnim.offsetX, nextAnim.offsetY)) {
                 // successfully blended
                 nextEntry->blendedImage = std::move(canvas);
+                nextEntry->bytes += FreeImage_GetMemorySize(nextEntry->blendedImage.get());
             }
         }
+        accumulate(mStats.compositeTime, elapsedMs(compositeStart));
+    }
+
+    updateCacheLimits(*nextEntry);
+    if (source->storesDifference()) {
+        saveCheckpoint(*nextEntry);
     }
 
     return nextEntry;
 }
 
+std::unique_ptr<Player::CacheEntry> Player::restoreCheckpoint(ImageSource* source, uint32_t idx)
+{
+    const auto it = mCheckpoints.find(idx);
+    if (it == mCheckpoints.cend()) {
+        throw std::logic_error("Player[restoreCheckpoint]: Checkpoint is not found.");
+    }
+    auto entry = loadFrame(source, idx);
+    if (it->second) {
+        entry->blendedImage.reset(FreeImage_Clone(it->second.get()));
+        if (!entry->blendedImage) {
+            throw std::runtime_error("Player[restoreCheckpoint]: Failed to copy canvas.");
+        }
+        entry->bytes += FreeImage_GetMemorySize(entry->blendedImage.get());
+    }
+    return entry;
+}
+
+void Player::updateCacheLimits(const CacheEntry& entry)
+{
+    mLoadedBytes += entry.bytes;
+    ++mLoadedFrames;
+
+    const size_t framesNum = mSource->pagesCount();
+    const size_t frameSize = std::max<size_t>(mLoadedBytes / mLoadedFrames, 1);
+    if (frameSize * framesNum <= kMaxCacheBytes) {
+        // The whole loop fits, checkpoints are not needed
+        mKeepLoop = true;
+        mMaxCacheSize = framesNum;
+        mCheckpointStep = 0;
+        mCheckpoints.clear();
+        mCheckpointsBytes = 0;
+    }
+    else {
+        mKeepLoop = false;
+        mMaxCacheSize = std::clamp(kMaxCacheBytes / frameSize, static_cast<size_t>(1), std::min(framesNum, kMaxCacheLength));
+        // Place checkpoints no denser than the cached window
+        const size_t maxCheckpoints = std::max<size_t>(kMaxCheckpointsBytes / frameSize, 1);
+        mCheckpointStep = static_cast<uint32_t>(std::max((framesNum + maxCheckpoints - 1) / maxCheckpoints, mMaxCacheSize));
+    }
+}
+
+void Player::saveCheckpoint(const CacheEntry& entry)
+{
+    const uint32_t idx = entry.page->index();
+    if (mKeepLoop || idx == 0 || mCheckpoints.count(idx) > 0) {
+        return;
+    }
+    if (!entry.blendedImage) {
+        // The page doesn't depend on previous frames, so checkpoint is free
+        mCheckpoints.emplace(idx, UniqueBitmap(nullptr, &::FreeImage_Unload));
+    }
+    else if ((mCheckpointStep > 0) && (idx % mCheckpointStep == 0)) {
+        const size_t canvasBytes = FreeImage_GetMemorySize(entry.blendedImage.get());
+        if (mCheckpointsBytes + canvasBytes <= kMaxCheckpointsBytes) {
+            UniqueBitmap canvas(FreeImage_Clone(entry.blendedImage.get()), &::FreeImage_Unload);
+            if (canvas) {
+                mCheckpoints.emplace(idx, std::move(canvas));
+                mCheckpointsBytes += canvasBytes;
+            }
+        }
+    }
+}
+
+bool Player::cacheIsOverflown() const
+{
+    return (mFramesCache.size() > mMaxCacheSize) || (mCacheBytes > kMaxCacheBytes && mFramesCache.size() > 1);
+}
+
+void Player::recordAccess(bool backward, bool hit)
+{
+    mDirectionHistory <<= 1;
+    mDirectionHistory.set(0, backward);
+    if (hit) {
+        ++mStats.cacheHits;
+    }
+    else {
+        ++mStats.cacheMisses;
+    }
+}
+
+bool Player::isCached(uint32_t idx) const
+{
+    return std::any_of(mFramesCache.cbegin(), mFramesCache.cend(), [idx](const auto& entry) { return entry->page->index() == idx; });
+}
+
+void Player::schedulePrefetch()
+{
+    const uint32_t framesNum = mSource->pagesCount();
+    if (mSource->storesDifference() || framesNum < 2 || mFramesCache.empty()) {
+        return;
+    }
+
+    const uint32_t currIdx = getCurrentPage().index();
+    const uint32_t distance = (mMaxCacheSize >= kMinCacheForFarPrefetch) ? 2 : 1;
+
+    std::vector<uint32_t> wanted;
+    for (uint32_t d = 1; d <= distance; ++d) {
+        wanted.push_back((currIdx + d) % framesNum);
+        wanted.push_back((currIdx + framesNum - d % framesNum) % framesNum);
+    }
+
+    // Drop pages far from the current one. Running tasks can't be interrupted, so they are kept until finished.
+    for (auto it = mPrefetched.begin(); it != mPrefetched.end(); ) {
+        const bool isWanted = std::find(wanted.cbegin(), wanted.cend(), it->first) != wanted.cend();
+        if (!isWanted && it->second.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            it = mPrefetched.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+
+    // Prefetched pages are held outside of the cache, so they are counted against its budget by the average frame size
+    const size_t frameSize = std::max<size_t>(mLoadedBytes / std::max<size_t>(mLoadedFrames, 1), 1);
+    for (size_t i = 0; i < wanted.size(); ++i) {
+        const uint32_t idx = wanted[i];
+        if (idx == currIdx || mPrefetched.count(idx) > 0 || isCached(idx)) {
+            continue;
+        }
+        const bool isFar = (i >= 2 * kNearPrefetchDistance);
+        if (isFar && mCacheBytes + (mPrefetched.size() + 1) * frameSize > kMaxCacheBytes) {
+            continue;
+        }
+        mPrefetched.emplace(idx, std::async(std::launch::async, &Player::decodeFrame, mSource, idx));
+    }
+}
+
 const ImagePage& Player::getCurrentPage() const
 {
     if (mCacheIndex < mFramesCache.size()) {
@@ -158,22 +346,29 @@ void Player::next()
         if (mCacheIndex < mFramesCache.size() - 1) {
             // Already cached
             ++mCacheIndex;
+            recordAccess(false, true);
         }
         else if(mFramesCache.front()->page->index() == nextIdx) {
             // Found in head
             mCacheIndex = 0;
+            recordAccess(false, true);
         }
         else  {
             // Load and save in tail
+            recordAccess(false, false);
             auto next = loadNextFrame(mSource.get(), *mFramesCache.back());
             if (next) {
+                mCacheBytes += next->bytes;
                 mFramesCache.push_back(std::move(next));
-                if (mFramesCache.size() > mMaxCacheSize) {
+                mCacheIndex = mFramesCache.size() - 1;
+                while (cacheIsOverflown() && mCacheIndex > 0) {
+                    mCacheBytes -= mFramesCache.front()->bytes;
                     mFramesCache.pop_front();
+                    --mCacheIndex;
                 }
-                mCacheIndex = mFramesCache.size() - 1;
             }
         }
+        schedulePrefetch();
     }
 }
 
@@ -187,36 +382,53 @@ void Player::prev()
         if (mCacheIndex > 0) {
             // Already cached
             --mCacheIndex;
+            recordAccess(true, true);
         }
         else if(mFramesCache.back()->page->index() == nextIdx) {
             // Found in head
             mCacheIndex = mFramesCache.size() - 1;
+            recordAccess(true, true);
         }
         else  {
+            recordAccess(true, false);
+
+            // Cache is a continuous run of frames, so either (back, nextIdx] or [0, nextIdx] is free
+            const uint32_t backIdx = mFramesCache.back()->page->index();
+            const uint32_t firstFreeIdx = (nextIdx > backIdx) ? backIdx + 1 : 0;
+
+            // The more user steps back, the more frames behind are kept
+            const size_t backwardSteps = mDirectionHistory.count();
+            const size_t freeSlots = mMaxCacheSize > mFramesCache.size() ? mMaxCacheSize - mFramesCache.size() : 0;
+            const size_t windowLength = mMaxCacheSize * (mDirectionHistory.size() + 2 * backwardSteps) / (3 * mDirectionHistory.size());
+            // Independent pages around are prefetched separately
+            const uint32_t countToCache = mSource->storesDifference() ? static_cast<uint32_t>(std::max(windowLength, freeSlots)) : 0;
+            const uint32_t cacheFromIdx = countToCache < nextIdx ? nextIdx - countToCache : 0; // add to cache frames with index >= cacheFromIdx
+
             // Find closest previous frame
             std::unique_ptr<CacheEntry> buffer = nullptr;
-            CacheEntry* lastEntry = nullptr;
-            if (nextIdx > mFramesCache.back()->page->index()) {
-                buffer = loadNextFrame(mSource.get(), *mFramesCache.back());
+            if (!mSource->storesDifference()) {
+                // Pages are independent, seek directly
+                buffer = loadFrame(mSource.get(), std::max(cacheFromIdx, firstFreeIdx));
+                updateCacheLimits(*buffer);
             }
             else {
-                buffer = loadZeroFrame(mSource.get());
+                auto checkpoint = mCheckpoints.upper_bound(nextIdx);
+                if (checkpoint != mCheckpoints.cbegin() && (--checkpoint)->first >= firstFreeIdx) {
+                    buffer = restoreCheckpoint(mSource.get(), checkpoint->first);
+                }
+                else if (firstFreeIdx > 0) {
+                    buffer = loadNextFrame(mSource.get(), *mFramesCache.back());
+                }
+                else {
+                    buffer = loadZeroFrame(mSource.get());
+                }
             }
-            lastEntry = buffer.get();
+            CacheEntry* lastEntry = buffer.get();
 
             // Load
-            const uint32_t countToCache = static_cast<uint32_t>(std::max(2 * mMaxCacheSize / 3, mMaxCacheSize - mFramesCache.size()));
-            const uint32_t cacheFromIdx = countToCache < nextIdx ? nextIdx - countToCache : 0; // add to cache frames with index >= cacheFromIdx
-
-            size_t cachedCount = mFramesCache.size();
-
             std::vector<std::unique_ptr<CacheEntry>> newFrames;
             if (lastEntry->page->index() >= cacheFromIdx) {
                 newFrames.push_back(std::move(buffer));
-                ++cachedCount;
-                if (cachedCount > mMaxCacheSize) {
-                    mFramesCache.pop_back();
-                }
             }
 
             while (lastEntry->page->index() < nextIdx) {
@@ -224,10 +436,6 @@ void Player::prev()
                 lastEntry = buffer.get();
                 if (lastEntry->page->index() >= cacheFromIdx) {
                     newFrames.push_back(std::move(buffer));
-                    ++cachedCount;
-                    if (cachedCount > mMaxCacheSize) {
-                        mFramesCache.pop_back();
-                    }
                 }
             }
 
@@ -235,12 +443,30 @@ void Player::prev()
                 throw std::logic_error("Player[prev]: Cache was corrupted.");
             }
 
+            for (const auto& entry : newFrames) {
+                mCacheBytes += entry->bytes;
+            }
             mCacheIndex = newFrames.size() - 1;
             mFramesCache.insert(mFramesCache.cbegin(), std::make_move_iterator(newFrames.begin()), std::make_move_iterator(newFrames.end()));
+
+            while (cacheIsOverflown() && mFramesCache.size() > mCacheIndex + 1) {
+                mCacheBytes -= mFramesCache.back()->bytes;
+                mFramesCache.pop_back();
+            }
         }
+        schedulePrefetch();
     }
 }
 
+PlaybackStats Player::getStats() const
+{
+    PlaybackStats stats = mStats;
+    stats.cacheLength   = mFramesCache.size();
+    stats.cacheCapacity = mMaxCacheSize;
+    stats.cacheBytes    = mCacheBytes + mCheckpointsBytes;
+    stats.checkpoints   = mCheckpoints.size();
+    return stats;
+}
 
 uint32_t Player::framesNumber() const
 {
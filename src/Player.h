@@ -19,16 +19,37 @@
 #ifndef PLAYER_H
 #define PLAYER_H
 
+#include <bitset>
 #include <deque>
+#include <future>
+#include <map>
 #include <type_traits>
 #include <memory>
-#include <deque>
 #include "FreeImageExt.h"
 
 class ImageSource;
 class ImagePage;
 class Pixel;
 
+/**
+ * Frames cache and decoding counters
+ */
+struct PlaybackStats
+{
+    uint64_t cacheHits   = 0;
+    uint64_t cacheMisses = 0;
+    uint64_t prefetchHits = 0;
+
+    size_t cacheLength   = 0;
+    size_t cacheCapacity = 0;
+    size_t cacheBytes    = 0;
+    size_t checkpoints   = 0;
+
+    // Milliseconds, smoothed
+    double decodeTime    = 0.0;
+    double compositeTime = 0.0;
+};
+
 class Player
 {
 public:
@@ -58,24 +79,74 @@ public:
 
     void prev();
 
+    PlaybackStats getStats() const;
+
 private:
     struct CacheEntry;
 
     //-------------------------------------------------------------------------------------
 
+    /**
+     * Decodes a page, safe to call from a worker thread
+     */
+    static std::unique_ptr<CacheEntry> decodeFrame(std::shared_ptr<ImageSource> source, uint32_t idx);
+
+    /**
+     * Takes prefetched page or decodes it
+     */
+    std::unique_ptr<CacheEntry> loadFrame(ImageSource* source, uint32_t idx);
+
     std::unique_ptr<CacheEntry> loadZeroFrame(ImageSource* source);
 
     std::unique_ptr<CacheEntry> loadNextFrame(ImageSource* source, const CacheEntry& prev);
 
+    std::unique_ptr<CacheEntry> restoreCheckpoint(ImageSource* source, uint32_t idx);
+
+    /**
+     * Recalculates cache limits from the measured size of a new frame
+     */
+    void updateCacheLimits(const CacheEntry& entry);
+
+    void saveCheckpoint(const CacheEntry& entry);
+
+    bool cacheIsOverflown() const;
+
+    void recordAccess(bool backward, bool hit);
+
+    bool isCached(uint32_t idx) const;
+
+    /**
+     * Starts decoding of the pages around the current one, farther pages only if the cache budget has room
+     */
+    void schedulePrefetch();
+
     //-------------------------------------------------------------------------------------
 
     std::shared_ptr<ImageSource> mSource;
 
     std::deque<std::unique_ptr<CacheEntry>> mFramesCache;
     size_t mCacheIndex   = 0;
+    size_t mCacheBytes   = 0;
     size_t mMaxCacheSize = 1;
+    bool   mKeepLoop     = false;
+
+    size_t mLoadedBytes  = 0;
+    size_t mLoadedFrames = 0;
+
+    // Blended canvases to restart composition from, for sources storing difference
+    std::map<uint32_t, UniqueBitmap> mCheckpoints;
+    size_t mCheckpointsBytes = 0;
+    uint32_t mCheckpointStep = 0;
+
+    // Recent accesses, bit is set for backward step
+    std::bitset<32> mDirectionHistory;
+
+    // Pages decoded in background, never overlap with the cache
+    std::map<uint32_t, std::future<std::unique_ptr<CacheEntry>>> mPrefetched;
 
     FIRGBA8 mBgColor{};
+
+    PlaybackStats mStats;
 };
 
 #endif // PLAYER_H
\ No newline at end of file
@@ -0,0 +1,98 @@
+/**
+ * @file
+ *
+ * Copyright 2018-2026 Alexey Gruzdev
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PROCESSINGPARAMS_H
+#define PROCESSINGPARAMS_H
+
+#include "FreeImageExt.h"
+#include "EnumArray.h"
+
+enum class Rotation
+{
+    eDegree0   = 0,
+    eDegree90  = 1,
+    eDegree180 = 2,
+    eDegree270 = 3,
+
+    length_
+};
+
+constexpr
+int toDegree(Rotation r)
+{
+    return 90 * static_cast<int>(r);
+}
+
+enum class FlipType
+{
+    eHorizontal,
+    eVertical,
+
+    length_
+};
+
+
+enum class ChannelSwizzle
+{
+    eRGB = 0,
+    eBGR,
+    eRed,
+    eGreen,
+    eBlue,
+    eAlpha,
+
+    length_
+};
+
+/**
+ * Parameters of the frame processing before display
+ */
+struct ProcessingParams
+{
+    Rotation rotation = Rotation::eDegree0;
+
+    EnumArray<bool, FlipType> flips = { false };
+
+    FREE_IMAGE_TMO toneMapping = FITMO_CLAMP;
+
+    /**
+     * Operator parameters, see ToneMapping::parameters(). Both zero select the defaults.
+     */
+    double toneMappingFirst  = 0.0;
+    double toneMappingSecond = 0.0;
+
+    double gamma = 1.0;
+
+    ChannelSwizzle swizzle = ChannelSwizzle::eRGB;
+};
+
+inline
+bool operator==(const ProcessingParams& lhs, const ProcessingParams& rhs)
+{
+    return lhs.rotation == rhs.rotation && lhs.flips.data == rhs.flips.data && lhs.toneMapping == rhs.toneMapping
+        && lhs.toneMappingFirst == rhs.toneMappingFirst && lhs.toneMappingSecond == rhs.toneMappingSecond
+        && lhs.gamma == rhs.gamma && lhs.swizzle == rhs.swizzle;
+}
+
+inline
+bool operator!=(const ProcessingParams& lhs, const ProcessingParams& rhs)
+{
+    return !(lhs == rhs);
+}
+
+#endif // PROCESSINGPARAMS_H
@@ -0,0 +1,205 @@
+/**
+ * @file
+ *
+ * Copyright 2018-2026 Alexey Gruzdev
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "Parallel.h"
+
+namespace
+{
+    /**
+     * Source pixels covered by each destination pixel with their normalized weights
+     */
+    struct AreaFilter
+    {
+        struct Taps
+        {
+            uint32_t first = 0;
+            uint32_t count = 0;
+            // Index of the first weight
+            size_t offset = 0;
+        };
+
+        std::vector<Taps> taps;
+        std::vector<float> weights;
+
+        AreaFilter(uint32_t srcSize, uint32_t dstSize)
+        {
+            const double scale = static_cast<double>(srcSize) / dstSize;
+            taps.resize(dstSize);
+            for (uint32_t i = 0; i < dstSize; ++i) {
+                const double begin = i * scale;
+                const double end   = std::min((i + 1) * scale, static_cast<double>(srcSize));
+                const uint32_t first = std::min(static_cast<uint32_t>(begin), srcSize - 1);
+                const uint32_t last  = std::clamp(static_cast<uint32_t>(std::ceil(end)), first + 1, srcSize);
+                taps[i] = Taps{ first, last - first, weights.size() };
+                for (uint32_t j = first; j < last; ++j) {
+                    const double overlap = std::min(end, j + 1.0) - std::max(begin, static_cast<double>(j));
+                    weights.push_back(static_cast<float>(std::max(overlap, 0.0) / (end - begin)));
+                }
+            }
+        }
+    };
+
+    template <uint32_t Channels_>
+    void filterRow(const uchar* src, const AreaFilter& filter, float* dst)
+    {
+        for (const auto& tap : filter.taps) {
+            const float* weights = filter.weights.data() + tap.offset;
+            const uchar* pixel = src + tap.first * Channels_;
+            float sum[Channels_] = {};
+            for (uint32_t k = 0; k < tap.count; ++k, pixel += Channels_) {
+                for (uint32_t c = 0; c < Channels_; ++c) {
+                    sum[c] += weights[k] * pixel[c];
+                }
+            }
+            for (uint32_t c = 0; c < Channels_; ++c) {
+                dst[c] = sum[c];
+            }
+            dst += Channels_;
+        }
+    }
+
+    template <uint32_t Channels_>
+    void areaRows(const QImage& src, const AreaFilter& columns, const AreaFilter& rows, uchar* dstBits, size_t dstPitch, uint32_t begin, uint32_t end, const std::atomic<bool>& cancelled)
+    {
+        const size_t rowSize = columns.taps.size() * Channels_;
+        std::vector<float> filtered(rowSize);
+        std::vector<float> accum(rowSize);
+        for (uint32_t y = begin; y < end && !cancelled; ++y) {
+            const auto& tap = rows.taps[y];
+            std::fill(accum.begin(), accum.end(), 0.0f);
+            for (uint32_t k = 0; k < tap.count; ++k) {
+                filterRow<Channels_>(src.constScanLine(static_cast<int>(tap.first + k)), columns, filtered.data());
+                const float weight = rows.weights[tap.offset + k];
+                for (size_t i = 0; i < rowSize; ++i) {
+                    accum[i] += weight * filtered[i];
+                }
+            }
+            uchar* dst = dstBits + y * dstPitch;
+            for (size_t i = 0; i < rowSize; ++i) {
+                dst[i] = static_cast<uchar>(std::min(accum[i] + 0.5f, 255.0f));
+            }
+        }
+    }
+}
+
+Resampler::~Resampler()
+{
+    reset();
+}
+
+QImage Resampler::toFilterableFormat(QImage image)
+{
+    switch (image.format()) {
+    case QImage::Format_Grayscale8:
+    case QImage::Format_RGB888:
+    case QImage::Format_RGBA8888_Premultiplied:
+        return image;
+    case QImage::Format_RGBA8888:
+        // Averaging of premultiplied colors doesn't bleed colors of transparent pixels
+        return image.convertToFormat(QImage::Format_RGBA8888_Premultiplied);
+    default:
+        // Downscaled binary image has intermediate values anyway
+        return image.convertToFormat(QImage::Format_Grayscale8);
+    }
+}
+
+QImage Resampler::area(const QImage& image, const QSize& size, const std::atomic<bool>& cancelled)
+{
+    if (image.isNull() || size.isEmpty()) {
+        throw std::logic_error("Resampler[area]: Empty image or size.");
+    }
+    QImage dst(size, image.format());
+    if (dst.isNull()) {
+        throw std::runtime_error("Resampler[area]: Failed to allocate image.");
+    }
+    const AreaFilter columns(static_cast<uint32_t>(image.width()),  static_cast<uint32_t>(size.width()));
+    const AreaFilter rows(static_cast<uint32_t>(image.height()), static_cast<uint32_t>(size.height()));
+    // Non-const access detaches, so it must be done before the parallel part
+    uchar* dstBits = dst.bits();
+    const size_t dstPitch = static_cast<size_t>(dst.bytesPerLine());
+    const uint32_t channels = static_cast<uint32_t>(image.depth() / 8);
+    const uint64_t rowCost = static_cast<uint64_t>(image.width()) * channels * image.height() / size.height();
+    parallelFor(static_cast<uint32_t>(size.height()), rowCost, [&](uint32_t begin, uint32_t end) {
+        switch (channels) {
+        case 1:
+            areaRows<1>(image, columns, rows, dstBits, dstPitch, begin, end, cancelled);
+            break;
+        case 3:
+            areaRows<3>(image, columns, rows, dstBits, dstPitch, begin, end, cancelled);
+            break;
+        case 4:
+            areaRows<4>(image, columns, rows, dstBits, dstPitch, begin, end, cancelled);
+            break;
+        default:
+            throw std::logic_error("Resampler[area]: Unsupported format.");
+        }
+    });
+    return cancelled ? QImage() : dst;
+}
+
+void Resampler::resample(qint64 key, QImage image, const QSize& size, std::function<void()> onReady)
+{
+    reset();
+    auto state = std::make_unique<State>();
+    state->key  = key;
+    state->size = size;
+    State* pState = state.get();
+    state->task = std::async(std::launch::async, [pState, image = std::move(image), onReady = std::move(onReady)]() {
+        try {
+            pState->image = area(toFilterableFormat(image), pState->size, pState->cancelled);
+        }
+        catch (...) {
+            // Fast path stays on the screen
+            return;
+        }
+        if (!pState->cancelled && !pState->image.isNull()) {
+            pState->ready = true;
+            if (onReady) {
+                onReady();
+            }
+        }
+    });
+    mState = std::move(state);
+}
+
+void Resampler::reset()
+{
+    if (mState) {
+        mState->cancelled = true;
+        mState.reset();
+    }
+    mResult = QPixmap();
+}
+
+QPixmap Resampler::result()
+{
+    if (!mState || !mState->ready) {
+        return QPixmap();
+    }
+    if (mResult.isNull()) {
+        mResult = QPixmap::fromImage(mState->image);
+    }
+    return mResult;
+}
@@ -0,0 +1,103 @@
+/**
+ * @file
+ *
+ * Copyright 2018-2026 Alexey Gruzdev
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+
+#include <QImage>
+#include <QPixmap>
+#include <QSize>
+
+/**
+ * High quality downscaling of the displayed image in background.
+ * Uses area averaging: each destination pixel is the exact mean of the source pixels it covers.
+ */
+class Resampler
+{
+public:
+    Resampler() = default;
+
+    Resampler(const Resampler&) = delete;
+
+    Resampler(Resampler&&) = delete;
+
+    ~Resampler();
+
+    Resampler& operator=(const Resampler&) = delete;
+
+    Resampler& operator=(Resampler&&) = delete;
+
+    /**
+     * Converts the image to a format, which can be averaged per byte: grayscale, RGB or premultiplied RGBA
+     */
+    static QImage toFilterableFormat(QImage image);
+
+    /**
+     * Downscales the image with area averaging in parallel.
+     * Image must have a filterable format, size must not exceed the image size.
+     * Returns null image if cancelled.
+     */
+    static QImage area(const QImage& image, const QSize& size, const std::atomic<bool>& cancelled);
+
+    /**
+     * Starts downscaling of the image in background, the previous result is dropped.
+     * @param key Identifies the image, see isRequested()
+     * @param onReady Called from the worker thread when the result is ready
+     */
+    void resample(qint64 key, QImage image, const QSize& size, std::function<void()> onReady);
+
+    /**
+     * Stops resampling and drops the result
+     */
+    void reset();
+
+    /**
+     * True if the last resample() was called for the key and size, even if the result is not ready yet
+     */
+    bool isRequested(qint64 key, const QSize& size) const
+    {
+        return mState && mState->key == key && mState->size == size;
+    }
+
+    /**
+     * Result of the last resample(), null pixmap if it is not ready yet
+     */
+    QPixmap result();
+
+private:
+    struct State
+    {
+        qint64 key = 0;
+        QSize size;
+        QImage image;
+        std::atomic<bool> ready{ false };
+        std::atomic<bool> cancelled{ false };
+        // Destructor of the future waits for the worker
+        std::future<void> task;
+    };
+
+    std::unique_ptr<State> mState;
+    QPixmap mResult;
+};
+
+#endif // RESAMPLER_H
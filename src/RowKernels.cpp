@@ -0,0 +1,413 @@
+/**
+ * @file
+ *
+ * Copyright 2018-2026 Alexey Gruzdev
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "RowKernels.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#include "Gamma.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+# define SHIBA_X86 1
+# ifdef _MSC_VER
+#  include <intrin.h>
+#  define SHIBA_TARGET(Isa_)
+# else
+#  define SHIBA_TARGET(Isa_) __attribute__((target(Isa_)))
+# endif
+# include <immintrin.h>
+#endif
+
+namespace
+{
+#ifdef SHIBA_X86
+    bool detectSsse3()
+    {
+# ifdef _MSC_VER
+        int info[4] = {};
+        __cpuid(info, 1);
+        return (info[2] & (1 << 9)) != 0;
+# else
+        return __builtin_cpu_supports("ssse3");
+# endif
+    }
+
+    bool detectSse2()
+    {
+# ifdef _MSC_VER
+        int info[4] = {};
+        __cpuid(info, 1);
+        return (info[3] & (1 << 26)) != 0;
+# else
+        return __builtin_cpu_supports("sse2");
+# endif
+    }
+
+    bool detectF16c()
+    {
+# ifdef _MSC_VER
+        // F16C instructions are VEX encoded, so OS must save AVX registers
+        int info[4] = {};
+        __cpuid(info, 1);
+        const bool f16c = (info[2] & (1 << 29)) != 0;
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        return f16c && osxsave && ((_xgetbv(0) & 0x6) == 0x6);
+# else
+        return __builtin_cpu_supports("f16c");
+# endif
+    }
+
+    const bool kHasSsse3 = detectSsse3();
+    const bool kHasSse2  = detectSse2();
+    const bool kHasF16c  = detectF16c();
+
+
+    SHIBA_TARGET("ssse3")
+    uint32_t swapRedBlue24Ssse3(const uint8_t* src, uint8_t* dst, uint32_t count)
+    {
+        // 4 pixels per step, the 4 extra bytes of each store are overwritten by the next step
+        const __m128i mask = _mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 12, 13, 14, 15);
+        uint32_t i = 0;
+        for (; 3 * i + 16 <= 3 * count; i += 4) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 3 * i), _mm_shuffle_epi8(v, mask));
+        }
+        return i;
+    }
+
+    SHIBA_TARGET("ssse3")
+    uint32_t swapRedBlue32Ssse3(const uint8_t* src, uint8_t* dst, uint32_t count)
+    {
+        const __m128i mask = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+        uint32_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4 * i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4 * i), _mm_shuffle_epi8(v, mask));
+        }
+        return i;
+    }
+
+    SHIBA_TARGET("ssse3")
+    uint32_t extractChannel24Ssse3(const uint8_t* src, uint32_t offset, uint8_t* dst, uint32_t count)
+    {
+        const char o = static_cast<char>(offset);
+        const __m128i mask = _mm_setr_epi8(o, o + 3, o + 6, o + 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+        uint32_t i = 0;
+        for (; 3 * i + 16 <= 3 * count; i += 4) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * i));
+            const int32_t packed = _mm_cvtsi128_si32(_mm_shuffle_epi8(v, mask));
+            std::memcpy(dst + i, &packed, sizeof(packed));
+        }
+        return i;
+    }
+
+    SHIBA_TARGET("ssse3")
+    uint32_t extractChannel32Ssse3(const uint8_t* src, uint32_t offset, uint8_t* dst, uint32_t count)
+    {
+        // Each of 4 loads fills its own quarter of the result
+        const char o = static_cast<char>(offset);
+        const __m128i mask0 = _mm_setr_epi8(o, o + 4, o + 8, o + 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+        const __m128i mask1 = _mm_setr_epi8(-1, -1, -1, -1, o, o + 4, o + 8, o + 12, -1, -1, -1, -1, -1, -1, -1, -1);
+        const __m128i mask2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, o, o + 4, o + 8, o + 12, -1, -1, -1, -1);
+        const __m128i mask3 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, o, o + 4, o + 8, o + 12);
+        uint32_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            const __m128i* p = reinterpret_cast<const __m128i*>(src + 4 * i);
+            __m128i r = _mm_shuffle_epi8(_mm_loadu_si128(p), mask0);
+            r = _mm_or_si128(r, _mm_shuffle_epi8(_mm_loadu_si128(p + 1), mask1));
+            r = _mm_or_si128(r, _mm_shuffle_epi8(_mm_loadu_si128(p + 2), mask2));
+            r = _mm_or_si128(r, _mm_shuffle_epi8(_mm_loadu_si128(p + 3), mask3));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), r);
+        }
+        return i;
+    }
+
+
+    // Lane-wise copies of Gamma::fastPow(), results must match the scalar version
+
+    SHIBA_TARGET("sse2")
+    inline
+    __m128 fastLog2Sse2(__m128 x)
+    {
+        const __m128i bits = _mm_castps_si128(x);
+        const __m128 e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+        __m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F800000)));
+        m = _mm_sub_ps(m, _mm_set1_ps(1.0f));
+        __m128 p = _mm_mul_ps(m, _mm_set1_ps(-0.0257923470f));
+        p = _mm_mul_ps(m, _mm_add_ps(_mm_set1_ps(0.121472954f), p));
+        p = _mm_mul_ps(m, _mm_add_ps(_mm_set1_ps(-0.277341653f), p));
+        p = _mm_mul_ps(m, _mm_add_ps(_mm_set1_ps(0.457158125f), p));
+        p = _mm_mul_ps(m, _mm_add_ps(_mm_set1_ps(-0.718033591f), p));
+        p = _mm_mul_ps(m, _mm_add_ps(_mm_set1_ps(1.44253478f), p));
+        return _mm_add_ps(e, p);
+    }
+
+    SHIBA_TARGET("sse2")
+    inline
+    __m128 fastExp2Sse2(__m128 x)
+    {
+        x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-126.0f)), _mm_set1_ps(127.0f));
+        const __m128i i = _mm_sub_epi32(_mm_cvttps_epi32(_mm_add_ps(x, _mm_set1_ps(126.0f))), _mm_set1_epi32(126));
+        const __m128 f = _mm_mul_ps(_mm_sub_ps(x, _mm_cvtepi32_ps(i)), _mm_set1_ps(0.693147181f));
+        __m128 ef = _mm_mul_ps(f, _mm_set1_ps(1.0f / 720.0f));
+        ef = _mm_mul_ps(f, _mm_add_ps(_mm_set1_ps(1.0f / 120.0f), ef));
+        ef = _mm_mul_ps(f, _mm_add_ps(_mm_set1_ps(1.0f / 24.0f), ef));
+        ef = _mm_mul_ps(f, _mm_add_ps(_mm_set1_ps(1.0f / 6.0f), ef));
+        ef = _mm_mul_ps(f, _mm_add_ps(_mm_set1_ps(1.0f / 2.0f), ef));
+        ef = _mm_mul_ps(f, _mm_add_ps(_mm_set1_ps(1.0f), ef));
+        ef = _mm_add_ps(_mm_set1_ps(1.0f), ef);
+        const __m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(i, _mm_set1_epi32(127)), 23));
+        return _mm_mul_ps(scale, ef);
+    }
+
+    /**
+     * Scaling, gamma and clamping of 4 lanes, the result is truncated to [0, 255]
+     */
+    template <bool UseGamma_>
+    SHIBA_TARGET("sse2")
+    inline
+    __m128i toIntSse2(__m128 v, __m128 scale, __m128 gamma, __m128 colorMask)
+    {
+        v = _mm_mul_ps(v, scale);
+        if (UseGamma_) {
+            // Zero for non-positive and NaN colors, alpha lanes are kept
+            const __m128 corrected = _mm_and_ps(_mm_cmpgt_ps(v, _mm_setzero_ps()), fastExp2Sse2(_mm_mul_ps(gamma, fastLog2Sse2(v))));
+            v = _mm_or_ps(_mm_and_ps(colorMask, corrected), _mm_andnot_ps(colorMask, v));
+        }
+        // max() returns the second operand for NaN
+        v = _mm_max_ps(_mm_mul_ps(v, _mm_set1_ps(256.0f)), _mm_setzero_ps());
+        return _mm_cvttps_epi32(_mm_min_ps(v, _mm_set1_ps(255.0f)));
+    }
+
+    SHIBA_TARGET("sse2")
+    inline
+    void load16Sse2(const float* src, __m128* v)
+    {
+        v[0] = _mm_loadu_ps(src);
+        v[1] = _mm_loadu_ps(src + 4);
+        v[2] = _mm_loadu_ps(src + 8);
+        v[3] = _mm_loadu_ps(src + 12);
+    }
+
+    /**
+     * Converts n values of interleaved pixels, 16 per step. Pixels of 4 channels are aligned to lanes.
+     */
+    template <bool UseGamma_>
+    SHIBA_TARGET("sse2")
+    uint32_t toBytesSse2(const float* src, uint32_t channels, uint8_t* dst, uint32_t n, float gain, float gamma)
+    {
+        const bool hasAlpha = (channels == 4);
+        const __m128 scale = hasAlpha ? _mm_setr_ps(gain, gain, gain, 1.0f) : _mm_set1_ps(gain);
+        const __m128 colorMask = _mm_castsi128_ps(hasAlpha ? _mm_setr_epi32(-1, -1, -1, 0) : _mm_set1_epi32(-1));
+        const __m128 gammaValue = _mm_set1_ps(gamma);
+        uint32_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            __m128 v[4];
+            load16Sse2(src + i, v);
+            const __m128i lo = _mm_packs_epi32(toIntSse2<UseGamma_>(v[0], scale, gammaValue, colorMask), toIntSse2<UseGamma_>(v[1], scale, gammaValue, colorMask));
+            const __m128i hi = _mm_packs_epi32(toIntSse2<UseGamma_>(v[2], scale, gammaValue, colorMask), toIntSse2<UseGamma_>(v[3], scale, gammaValue, colorMask));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+        }
+        return i;
+    }
+
+    SHIBA_TARGET("f16c")
+    uint32_t halfToFloatF16c(const uint16_t* src, float* dst, uint32_t count)
+    {
+        uint32_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const __m128i h = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i));
+            _mm_storeu_ps(dst + i, _mm_cvtph_ps(h));
+        }
+        return i;
+    }
+
+    SHIBA_TARGET("f16c")
+    uint32_t floatToHalfF16c(const float* src, uint16_t* dst, uint32_t count, bool* exact)
+    {
+        // Lanes stay set while the values survive the round trip, NaNs are not compared
+        __m128 equal = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        uint32_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const __m128 v = _mm_loadu_ps(src + i);
+            const __m128i h = _mm_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), h);
+            equal = _mm_and_ps(equal, _mm_or_ps(_mm_cmpeq_ps(_mm_cvtph_ps(h), v), _mm_cmpunord_ps(v, v)));
+        }
+        *exact = (_mm_movemask_ps(equal) == 0xF);
+        return i;
+    }
+#endif // SHIBA_X86
+
+    uint16_t toHalf(float v)
+    {
+        uint32_t bits = 0;
+        std::memcpy(&bits, &v, sizeof(bits));
+        const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+        bits &= 0x7FFFFFFFu;
+        if (bits >= 0x7F800000u) {
+            // Inf or NaN, NaN stays quiet
+            return sign | 0x7C00u | ((bits > 0x7F800000u) ? (0x0200u | ((bits >> 13) & 0x03FFu)) : 0u);
+        }
+        if (bits >= 0x477FF000u) {
+            // Rounds above 65504
+            return sign | 0x7C00u;
+        }
+        if (bits < 0x38800000u) {
+            // Subnormal, the value in units of 2^-24 is exact in float and is rounded to nearest even
+            float a = 0.0f;
+            std::memcpy(&a, &bits, sizeof(a));
+            return sign | static_cast<uint16_t>(std::nearbyint(a * 16777216.0f));
+        }
+        uint32_t h = ((bits >> 23) - 112) << 10 | ((bits >> 13) & 0x03FFu);
+        const uint32_t rest = bits & 0x1FFFu;
+        if (rest > 0x1000u || (rest == 0x1000u && (h & 1u))) {
+            // Carry may propagate to the exponent, which is still correct
+            ++h;
+        }
+        return sign | static_cast<uint16_t>(h);
+    }
+
+    inline
+    uint8_t toByte(float v, float gamma)
+    {
+        if (gamma != 1.0f) {
+            v = (v > 0.0f) ? Gamma::fastPow(v, gamma) : 0.0f;
+        }
+        // Same as FreeImage_TmoClamp. NaN is mapped to zero.
+        const float s = 256.0f * v;
+        return (s > 0.0f) ? ((s < 255.0f) ? static_cast<uint8_t>(s) : 255) : 0;
+    }
+
+}
+
+void RowKernels::swapRedBlue24(const uint8_t* src, uint8_t* dst, uint32_t count)
+{
+    assert(count == 0 || (src && dst));
+    uint32_t i = 0;
+#ifdef SHIBA_X86
+    if (kHasSsse3) {
+        i = swapRedBlue24Ssse3(src, dst, count);
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[3 * i]     = src[3 * i + 2];
+        dst[3 * i + 1] = src[3 * i + 1];
+        dst[3 * i + 2] = src[3 * i];
+    }
+}
+
+void RowKernels::swapRedBlue32(const uint8_t* src, uint8_t* dst, uint32_t count)
+{
+    assert(count == 0 || (src && dst));
+    uint32_t i = 0;
+#ifdef SHIBA_X86
+    if (kHasSsse3) {
+        i = swapRedBlue32Ssse3(src, dst, count);
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[4 * i]     = src[4 * i + 2];
+        dst[4 * i + 1] = src[4 * i + 1];
+        dst[4 * i + 2] = src[4 * i];
+        dst[4 * i + 3] = src[4 * i + 3];
+    }
+}
+
+void RowKernels::extractChannel(const uint8_t* src, uint32_t pixelSize, uint32_t offset, uint8_t* dst, uint32_t count)
+{
+    assert(count == 0 || (src && dst));
+    assert((pixelSize == 3 || pixelSize == 4) && offset < pixelSize);
+    uint32_t i = 0;
+#ifdef SHIBA_X86
+    if (kHasSsse3) {
+        i = (pixelSize == 3) ? extractChannel24Ssse3(src, offset, dst, count) : extractChannel32Ssse3(src, offset, dst, count);
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[i] = src[pixelSize * i + offset];
+    }
+}
+
+void RowKernels::floatToBytes(const float* src, uint32_t channels, uint8_t* dst, uint32_t count, float gain, float gamma)
+{
+    assert(count == 0 || (src && dst));
+    assert(channels == 1 || channels == 3 || channels == 4);
+    const uint32_t n = channels * count;
+    uint32_t i = 0;
+#ifdef SHIBA_X86
+    if (kHasSse2) {
+        i = (gamma != 1.0f)
+            ? toBytesSse2<true>(src, channels, dst, n, gain, gamma)
+            : toBytesSse2<false>(src, channels, dst, n, gain, gamma);
+    }
+#endif
+    for (; i < n; ++i) {
+        const bool alpha = (channels == 4) && ((i & 3) == 3);
+        dst[i] = alpha ? toByte(src[i], 1.0f) : toByte(src[i] * gain, gamma);
+    }
+}
+
+void RowKernels::halfToBytes(const uint16_t* src, uint32_t channels, uint8_t* dst, uint32_t count, float gain, float gamma)
+{
+    assert(count == 0 || (src && dst));
+    assert(channels == 1 || channels == 3 || channels == 4);
+    // Expanded by small chunks which stay in L1 cache
+    constexpr uint32_t kChunk = 256;
+    float buffer[4 * kChunk];
+    for (uint32_t i = 0; i < count; i += kChunk) {
+        const uint32_t n = std::min(kChunk, count - i);
+        halfToFloat(src + channels * i, buffer, channels * n);
+        floatToBytes(buffer, channels, dst + channels * i, n, gain, gamma);
+    }
+}
+
+void RowKernels::halfToFloat(const uint16_t* src, float* dst, uint32_t count)
+{
+    assert(count == 0 || (src && dst));
+    uint32_t i = 0;
+#ifdef SHIBA_X86
+    if (kHasF16c) {
+        i = halfToFloatF16c(src, dst, count);
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[i] = halfToFloat(src[i]);
+    }
+}
+
+bool RowKernels::floatToHalf(const float* src, uint16_t* dst, uint32_t count)
+{
+    assert(count == 0 || (src && dst));
+    bool exact = true;
+    uint32_t i = 0;
+#ifdef SHIBA_X86
+    if (kHasF16c) {
+        i = floatToHalfF16c(src, dst, count, &exact);
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[i] = toHalf(src[i]);
+        const float back = halfToFloat(dst[i]);
+        exact = exact && (back == src[i] || std::isnan(src[i]));
+    }
+    return exact;
+}
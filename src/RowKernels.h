@@ -0,0 +1,94 @@
+/**
+ * @file
+ *
+ * Copyright 2018-2026 Alexey Gruzdev
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ROWKERNELS_H
+#define ROWKERNELS_H
+
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Conversions of contiguous pixel rows, vectorized if the CPU supports it.
+ * Source and destination must not overlap.
+ */
+class RowKernels
+{
+public:
+    /**
+     * Swaps the first and the third bytes of 3 byte pixels
+     */
+    static void swapRedBlue24(const uint8_t* src, uint8_t* dst, uint32_t count);
+
+    /**
+     * Swaps the first and the third bytes of 4 byte pixels
+     */
+    static void swapRedBlue32(const uint8_t* src, uint8_t* dst, uint32_t count);
+
+    /**
+     * Copies a single byte of 3 or 4 byte pixels
+     */
+    static void extractChannel(const uint8_t* src, uint32_t pixelSize, uint32_t offset, uint8_t* dst, uint32_t count);
+
+    /**
+     * Converts pixels of 1, 3 or 4 floats to bytes clamping as FreeImage_TmoClamp.
+     * Color channels are multiplied by gain and raised to gamma, the fourth channel is alpha and is only clamped.
+     */
+    static void floatToBytes(const float* src, uint32_t channels, uint8_t* dst, uint32_t count, float gain, float gamma);
+
+    /**
+     * Same as floatToBytes() for IEEE 754 half precision values
+     */
+    static void halfToBytes(const uint16_t* src, uint32_t channels, uint8_t* dst, uint32_t count, float gain, float gamma);
+
+    /**
+     * Expands half precision values to floats
+     */
+    static void halfToFloat(const uint16_t* src, float* dst, uint32_t count);
+
+    /**
+     * Rounds floats to the nearest half precision values.
+     * Returns false if some value was not exactly representable.
+     */
+    static bool floatToHalf(const float* src, uint16_t* dst, uint32_t count);
+
+    static
+    float halfToFloat(uint16_t h)
+    {
+        const uint32_t sign = static_cast<uint32_t>(h & 0x8000u) << 16;
+        const uint32_t exponent = (h >> 10) & 0x1Fu;
+        const uint32_t mantissa = h & 0x03FFu;
+        uint32_t bits = 0;
+        if (exponent == 0) {
+            // Zero or subnormal, exact in float
+            float v = static_cast<float>(mantissa) * (1.0f / 16777216.0f);
+            std::memcpy(&bits, &v, sizeof(bits));
+            bits |= sign;
+        }
+        else if (exponent == 0x1Fu) {
+            bits = sign | 0x7F800000u | (mantissa << 13);
+        }
+        else {
+            bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+        }
+        float result = 0.0f;
+        std::memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+};
+
+#endif // ROWKERNELS_H
@@ -60,6 +60,8 @@ const QString Settings::kParamShowCloseButtonKey = "ShowCloseButton";
 const QString Settings::kParamShowCloseButtonDefault = "0";
 const QString Settings::kParamInvertZoom = "InvertZoom";
 const QString Settings::kParamInvertZoomDefault = "0";
+const QString Settings::kParamOpenGLCanvasKey = "OpenGLCanvas";
+const QString Settings::kParamOpenGLCanvasDefault = "0";
 
 // [Plugins]
 const QString  Settings::kPluginFloUsage  = "Flo";
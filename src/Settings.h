@@ -46,6 +46,8 @@ public:
     static const QString kParamShowCloseButtonDefault;
     static const QString kParamInvertZoom;
     static const QString kParamInvertZoomDefault;
+    static const QString kParamOpenGLCanvasKey;
+    static const QString kParamOpenGLCanvasDefault;
 
     // [Plugins]
     static const QString  kPluginFloUsage;
@@ -120,6 +120,10 @@ SettingsWidget::SettingsWidget()
         mInvertZoom = appendOption(gridGlobal, "Invert zoom direction", std::make_unique<QCheckBox2>(nullptr));
         mInvertZoom->setChecked(mSettings->value(Settings::kParamInvertZoom, Settings::kParamInvertZoomDefault).toBool());
 
+        //
+        mOpenGLCanvas = appendOption(gridGlobal, "Draw with OpenGL", std::make_unique<QCheckBox2>(nullptr));
+        mOpenGLCanvas->setChecked(mSettings->value(Settings::kParamOpenGLCanvasKey, Settings::kParamOpenGLCanvasDefault).toBool());
+
         vlayout->addWidget(gridWidget);
 
     } // [Global]
@@ -218,6 +222,9 @@ void SettingsWidget::showEvent(QShowEvent* event)
         if (mInvertZoom) {
             mInvertZoom->setChecked(mSettings->value(Settings::kParamInvertZoom, Settings::kParamInvertZoomDefault).toBool());
         }
+        if (mOpenGLCanvas) {
+            mOpenGLCanvas->setChecked(mSettings->value(Settings::kParamOpenGLCanvasKey, Settings::kParamOpenGLCanvasDefault).toBool());
+        }
     }
 
     if (mPluginsSettings) {
@@ -256,6 +263,10 @@ void SettingsWidget::onApply()
             mSettings->setValue(Settings::kParamInvertZoom, mInvertZoom->isChecked());
             globalsChanged = true;
         }
+        if (mOpenGLCanvas && mOpenGLCanvas->isModified()) {
+            mSettings->setValue(Settings::kParamOpenGLCanvasKey, mOpenGLCanvas->isChecked());
+            globalsChanged = true;
+        }
     }
 
     bool pluginsChanged{ false };
@@ -63,6 +63,7 @@ private:
     QLineEdit* mEditTextColor{ nullptr };
     QCheckBox2* mShowCloseButton{ nullptr };
     QCheckBox2* mInvertZoom{ nullptr };
+    QCheckBox2* mOpenGLCanvas{ nullptr };
 
     std::unique_ptr<UsageCheckboxes> mPluginUsageFlo;
     std::unique_ptr<UsageCheckboxes> mPluginUsageSvg;
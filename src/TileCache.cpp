@@ -0,0 +1,212 @@
+/**
+ * @file
+ *
+ * Copyright 2018-2026 Alexey Gruzdev
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "TileCache.h"
+
+#include <algorithm>
+
+#include "Parallel.h"
+
+namespace
+{
+    // 128 MB of RGB32 tiles
+    constexpr size_t kMaxTiles = 512;
+
+    // Zoom levels kept in the cache
+    constexpr size_t kMaxScenes = 4;
+
+    QRect tileRect(int x, int y, const QSize& sceneSize)
+    {
+        return QRect(x * TileCache::kTileSize, y * TileCache::kTileSize, TileCache::kTileSize, TileCache::kTileSize) & QRect(QPoint(0, 0), sceneSize);
+    }
+
+    // Same pattern as the canvas draws, images are safe to use on workers unlike pixmaps
+    QImage checkerboardPattern()
+    {
+        QImage pattern(16, 16, QImage::Format_RGB32);
+        pattern.fill(Qt::white);
+        QPainter painter(&pattern);
+        painter.fillRect(0, 0, 8, 8, QColor(Qt::lightGray));
+        painter.fillRect(8, 8, 8, 8, QColor(Qt::lightGray));
+        return pattern;
+    }
+}
+
+TileCache::TileCache(std::function<void()> onTileReady)
+    : mOnTileReady(std::move(onTileReady))
+{ }
+
+TileCache::~TileCache()
+{
+    clear();
+}
+
+void TileCache::clear()
+{
+    if (mJob) {
+        mJob->cancelled = true;
+        mJob.reset();
+    }
+    mTiles.clear();
+    mScenes.clear();
+    mSourceImage = QImage();
+    mSourceKey = 0;
+}
+
+uint32_t TileCache::sceneId(const Scene& scene)
+{
+    for (const auto& [cached, id] : mScenes) {
+        if (cached == scene) {
+            return id;
+        }
+    }
+    if (mScenes.size() >= kMaxScenes) {
+        const uint32_t oldest = mScenes.front().second;
+        for (auto it = mTiles.begin(); it != mTiles.end();) {
+            it = (it->first.scene == oldest) ? mTiles.erase(it) : std::next(it);
+        }
+        mScenes.erase(mScenes.begin());
+    }
+    mScenes.emplace_back(scene, mNextSceneId);
+    return mNextSceneId++;
+}
+
+void TileCache::takeRendered()
+{
+    if (!mJob) {
+        return;
+    }
+    std::vector<RenderedTile> rendered;
+    {
+        std::lock_guard<std::mutex> lock(mJob->mutex);
+        rendered.swap(mJob->rendered);
+    }
+    const auto sceneIt = std::find_if(mScenes.cbegin(), mScenes.cend(), [this](const auto& entry) { return entry.second == mJobScene; });
+    if (sceneIt != mScenes.cend()) {
+        for (auto& tile : rendered) {
+            QPixmap pixmap = QPixmap::fromImage(std::move(tile.image));
+            pixmap.setDevicePixelRatio(sceneIt->first.devicePixelRatio);
+            mTiles[tile.key] = Tile{ std::move(pixmap), 0 };
+        }
+    }
+    if (mJob->ready) {
+        mJob.reset();
+    }
+}
+
+void TileCache::startJob(const Scene& scene, uint32_t id, std::vector<TileKey> keys)
+{
+    auto job = std::make_unique<Job>();
+    Job* pJob = job.get();
+    job->task = std::async(std::launch::async, [pJob, image = mSourceImage, scene, keys = std::move(keys), onReady = mOnTileReady]() {
+        const QImage pattern = scene.checkerboard ? checkerboardPattern() : QImage();
+        parallelFor(static_cast<uint32_t>(keys.size()), kTileSize * kTileSize, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end && !pJob->cancelled; ++i) {
+                const QRect rect = tileRect(keys[i].x, keys[i].y, scene.size);
+                QImage tile(rect.size(), QImage::Format_RGB32);
+                if (tile.isNull()) {
+                    continue;
+                }
+                tile.fill(scene.background);
+                {
+                    QPainter painter(&tile);
+                    if (scene.checkerboard) {
+                        // Pattern is in logical pixels with the origin in the corner of the image
+                        painter.setTransform(QTransform::fromScale(scene.devicePixelRatio, scene.devicePixelRatio) * QTransform::fromTranslate(-rect.x(), -rect.y()));
+                        painter.fillRect(QRectF(QPointF(rect.topLeft()) / scene.devicePixelRatio, QSizeF(rect.size()) / scene.devicePixelRatio), QBrush(pattern));
+                    }
+                    painter.setRenderHint(QPainter::RenderHint::SmoothPixmapTransform, scene.smooth);
+                    painter.setTransform(scene.transform * QTransform::fromTranslate(-rect.x(), -rect.y()));
+                    painter.drawImage(QPointF(0.0, 0.0), image);
+                }
+                std::lock_guard<std::mutex> lock(pJob->mutex);
+                pJob->rendered.push_back(RenderedTile{ keys[i], std::move(tile) });
+            }
+        });
+        pJob->ready = true;
+        if (onReady) {
+            onReady();
+        }
+    });
+    mJob = std::move(job);
+    mJobScene = id;
+}
+
+void TileCache::evict()
+{
+    if (mTiles.size() <= kMaxTiles) {
+        return;
+    }
+    std::vector<std::pair<uint64_t, TileKey>> byAge;
+    byAge.reserve(mTiles.size());
+    for (const auto& [key, tile] : mTiles) {
+        byAge.emplace_back(tile.lastUsed, key);
+    }
+    const size_t excess = mTiles.size() - kMaxTiles;
+    std::nth_element(byAge.begin(), byAge.begin() + excess, byAge.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+    for (size_t i = 0; i < excess; ++i) {
+        mTiles.erase(byAge[i].second);
+    }
+}
+
+QRegion TileCache::draw(QPainter& painter, const QPoint& origin, const QRect& visible, const Scene& scene, const QPixmap& source)
+{
+    ++mDrawCounter;
+    takeRendered();
+    if (scene.sourceKey != mSourceKey) {
+        clear();
+        mSourceKey = scene.sourceKey;
+        mSourceImage = source.toImage();
+    }
+    const uint32_t id = sceneId(scene);
+    if (mJob && mJobScene != id) {
+        // Tiles of another zoom level are not needed anymore
+        mJob->cancelled = true;
+    }
+
+    const qreal ratio = scene.devicePixelRatio;
+    const QRectF visibleLocal = QRectF(visible.translated(-origin));
+    const QRect area = QRectF(visibleLocal.topLeft() * ratio, visibleLocal.size() * ratio).toAlignedRect() & QRect(QPoint(0, 0), scene.size);
+    QRegion missing;
+    if (area.isEmpty()) {
+        return missing;
+    }
+    std::vector<TileKey> requests;
+    for (int y = area.top() / kTileSize; y <= area.bottom() / kTileSize; ++y) {
+        for (int x = area.left() / kTileSize; x <= area.right() / kTileSize; ++x) {
+            const TileKey key{ id, x, y };
+            const QRect rect = tileRect(x, y, scene.size);
+            const QPointF position = QPointF(origin) + QPointF(rect.topLeft()) / ratio;
+            const auto it = mTiles.find(key);
+            if (it != mTiles.end()) {
+                it->second.lastUsed = mDrawCounter;
+                painter.drawPixmap(position, it->second.pixmap);
+            }
+            else {
+                missing += QRectF(position, QSizeF(rect.size()) / ratio).toAlignedRect();
+                requests.push_back(key);
+            }
+        }
+    }
+    // The running job calls back when finished, then the rest is requested
+    if (!requests.empty() && !mJob) {
+        startJob(scene, id, std::move(requests));
+    }
+    evict();
+    return missing;
+}
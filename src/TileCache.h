@@ -0,0 +1,168 @@
+/**
+ * @file
+ *
+ * Copyright 2018-2026 Alexey Gruzdev
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TILECACHE_H
+#define TILECACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+#include <QColor>
+#include <QImage>
+#include <QPainter>
+#include <QPixmap>
+#include <QRegion>
+#include <QTransform>
+
+/**
+ * Cache of the displayed image split into fixed size tiles in screen pixels.
+ * Tiles are rendered on workers, so panning only blits tiles and produces newly exposed ones.
+ * The image is composited over the background into opaque tiles, so that drawing doesn't blend.
+ */
+class TileCache
+{
+public:
+    static constexpr int kTileSize = 256;
+
+    /**
+     * Placement of the source on the screen.
+     * Tiles space is in device pixels with the origin in the top left corner of the displayed image.
+     */
+    struct Scene
+    {
+        // Source pixmap, see QPixmap::cacheKey()
+        qint64 sourceKey = 0;
+        // Maps source pixmap coordinates to the tiles space
+        QTransform transform;
+        // Size of the displayed image in device pixels
+        QSize size;
+        qreal devicePixelRatio = 1.0;
+        bool smooth = false;
+        // Shown under transparent pixels
+        QColor background;
+        // Transparency checkerboard with 8 logical pixels cells, aligned to the displayed image
+        bool checkerboard = false;
+
+        bool operator==(const Scene& other) const
+        {
+            return sourceKey == other.sourceKey && transform == other.transform && size == other.size
+                && devicePixelRatio == other.devicePixelRatio && smooth == other.smooth
+                && background == other.background && checkerboard == other.checkerboard;
+        }
+
+        bool operator!=(const Scene& other) const
+        {
+            return !(*this == other);
+        }
+    };
+
+    /**
+     * @param onTileReady Called from the worker thread when requested tiles are rendered
+     */
+    explicit TileCache(std::function<void()> onTileReady);
+
+    TileCache(const TileCache&) = delete;
+
+    TileCache(TileCache&&) = delete;
+
+    ~TileCache();
+
+    TileCache& operator=(const TileCache&) = delete;
+
+    TileCache& operator=(TileCache&&) = delete;
+
+    /**
+     * Draws cached tiles of the scene intersecting the visible rectangle and requests the missing ones.
+     * Painter must have no transform, the image is placed at the origin in logical coordinates.
+     * @return Region in logical coordinates, which was not drawn
+     */
+    QRegion draw(QPainter& painter, const QPoint& origin, const QRect& visible, const Scene& scene, const QPixmap& source);
+
+    /**
+     * Drops all tiles and cancels rendering
+     */
+    void clear();
+
+private:
+    struct TileKey
+    {
+        uint32_t scene;
+        int x;
+        int y;
+
+        bool operator<(const TileKey& other) const
+        {
+            return std::tie(scene, x, y) < std::tie(other.scene, other.x, other.y);
+        }
+    };
+
+    struct Tile
+    {
+        QPixmap pixmap;
+        // Draw call the tile was used last time, for eviction
+        uint64_t lastUsed = 0;
+    };
+
+    struct RenderedTile
+    {
+        TileKey key;
+        QImage image;
+    };
+
+    struct Job
+    {
+        std::atomic<bool> cancelled{ false };
+        std::atomic<bool> ready{ false };
+        std::mutex mutex;
+        std::vector<RenderedTile> rendered;
+        // Destructor of the future waits for the worker
+        std::future<void> task;
+    };
+
+    uint32_t sceneId(const Scene& scene);
+
+    void takeRendered();
+
+    void startJob(const Scene& scene, uint32_t id, std::vector<TileKey> keys);
+
+    void evict();
+
+    std::function<void()> mOnTileReady;
+
+    // Recently drawn scenes of the current source, to reuse tiles when zoom returns to a previous level
+    std::vector<std::pair<Scene, uint32_t>> mScenes;
+    uint32_t mNextSceneId = 0;
+
+    QImage mSourceImage;
+    qint64 mSourceKey = 0;
+
+    std::map<TileKey, Tile> mTiles;
+    uint64_t mDrawCounter = 0;
+
+    std::unique_ptr<Job> mJob;
+    uint32_t mJobScene = 0;
+};
+
+#endif // TILECACHE_H
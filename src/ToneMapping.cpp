@@ -0,0 +1,208 @@
+/**
+ * @file
+ *
+ * Copyright 2018-2026 Alexey Gruzdev
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ToneMapping.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "Parallel.h"
+#include "PixelTraits.h"
+
+namespace
+{
+    // Y row of sRGB to XYZ matrix
+    constexpr float kLumRed   = 0.21263903f;
+    constexpr float kLumGreen = 0.71516865f;
+    constexpr float kLumBlue  = 0.07219231f;
+
+    // Cost of a pixel of a simple pass, used to split work between threads
+    constexpr uint64_t kPixelCost = 1;
+
+    /**
+     * Single channel float image
+     */
+    struct Plane
+    {
+        uint32_t width  = 0;
+        uint32_t height = 0;
+        std::vector<float> data;
+
+        Plane() = default;
+
+        Plane(uint32_t w, uint32_t h, float value = 0.0f)
+            : width(w), height(h), data(static_cast<size_t>(w) * h, value)
+        { }
+
+        float* row(uint32_t y)
+        {
+            return data.data() + static_cast<size_t>(y) * width;
+        }
+
+        const float* row(uint32_t y) const
+        {
+            return data.data() + static_cast<size_t>(y) * width;
+        }
+    };
+
+    /**
+     * Planar RGB image
+     */
+    struct RgbPlanes
+    {
+        Plane r, g, b;
+
+        uint32_t width() const
+        {
+            return r.width;
+        }
+
+        uint32_t height() const
+        {
+            return r.height;
+        }
+    };
+
+    struct Range
+    {
+        float min = std::numeric_limits<float>::max();
+        float max = std::numeric_limits<float>::lowest();
+
+        static Range merge(const Range& lhs, const Range& rhs)
+        {
+            Range res;
+            res.min = std::min(lhs.min, rhs.min);
+            res.max = std::max(lhs.max, rhs.max);
+            return res;
+        }
+    };
+
+
+    bool loadPlanes(FIBITMAP* src, RgbPlanes* img)
+    {
+        const PixelFormat format = pixelFormat(src);
+        if (!isFloatingPoint(format)) {
+            return false;
+        }
+        const uint32_t width  = FreeImage_GetWidth(src);
+        const uint32_t height = FreeImage_GetHeight(src);
+        if (!width || !height) {
+            return false;
+        }
+        img->r = Plane(width, height);
+        img->g = Plane(width, height);
+        img->b = Plane(width, height);
+        visitPixels(format, [&](auto traits) {
+            using Traits = decltype(traits);
+            parallelFor(height, width * kPixelCost, [&](uint32_t begin, uint32_t end) {
+                for (uint32_t y = begin; y < end; ++y) {
+                    const uint8_t* line = FreeImage_GetScanLine(src, static_cast<int>(y));
+                    float* r = img->r.row(y);
+                    float* g = img->g.row(y);
+                    float* b = img->b.row(y);
+                    for (uint32_t x = 0; x < width; ++x) {
+                        if (Traits::kChannels == 1) {
+                            r[x] = g[x] = b[x] = Traits::red(line, x);
+                        }
+                        else {
+                            r[x] = Traits::red(line, x);
+                            g[x] = Traits::green(line, x);
+                            b[x] = Traits::blue(line, x);
+                        }
+                    }
+                }
+            });
+        });
+        return true;
+    }
+
+    Plane luminance(const RgbPlanes& img)
+    {
+        Plane lum(img.width(), img.height());
+        parallelFor(img.height(), img.width() * kPixelCost, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t y = begin; y < end; ++y) {
+                const float* r = img.r.row(y);
+                const float* g = img.g.row(y);
+                const float* b = img.b.row(y);
+                float* l = lum.row(y);
+                for (uint32_t x = 0; x < img.width(); ++x) {
+                    // Negative and NaN values are mapped to zero
+                    l[x] = std::max(0.0f, kLumRed * r[x] + kLumGreen * g[x] + kLumBlue * b[x]);
+                }
+            }
+        });
+        return lum;
+    }
+
+    /**
+     * Minimum and maximum of finite values
+     */
+    Range finiteRange(const Plane& p)
+    {
+        return parallelReduce(p.height, p.width * kPixelCost, Range{}, [&](uint32_t begin, uint32_t end) {
+            Range range;
+            for (uint32_t y = begin; y < end; ++y) {
+                const float* v = p.row(y);
+                for (uint32_t x = 0; x < p.width; ++x) {
+                    if (std::isfinite(v[x])) {
+                        range.min = std::min(range.min, v[x]);
+                        range.max = std::max(range.max, v[x]);
+                    }
+                }
+            }
+            return range;
+        }, &Range::merge);
+    }
+
+} // namespace
+
+
+std::vector<ToneMapping::Parameter> ToneMapping::parameters(FREE_IMAGE_TMO mode)
+{
+    switch (mode) {
+    case FITMO_DRAGO03:
+        return { { "Gamma", 1.0, 3.0, 2.2 }, { "Exposure", -8.0, 8.0, 0.0 } };
+    case FITMO_REINHARD05:
+        // Zero contrast means automatic selection from the log average
+        return { { "Intensity", -8.0, 8.0, 0.0 }, { "Contrast", 0.0, 1.0, 0.0 } };
+    case FITMO_FATTAL02:
+        return { { "Saturation", 0.0, 1.0, 0.5 }, { "Attenuation", 0.7, 1.0, 0.85 } };
+    default:
+        return {};
+    }
+}
+
+bool ToneMapping::linearRange(FIBITMAP* src, float* low, float* high)
+{
+    if (!src || !low || !high) {
+        return false;
+    }
+    RgbPlanes img;
+    if (!loadPlanes(src, &img)) {
+        return false;
+    }
+    const Range range = finiteRange((pixelChannels(pixelFormat(src)) == 1) ? img.r : luminance(img));
+    if (!(range.max > range.min)) {
+        return false;
+    }
+    *low  = range.min;
+    *high = range.max;
+    return true;
+}
@@ -0,0 +1,55 @@
+/**
+ * @file
+ *
+ * Copyright 2018-2026 Alexey Gruzdev
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TONEMAPPING_H
+#define TONEMAPPING_H
+
+#include <vector>
+#include "FreeImageExt.h"
+
+/**
+ * Parameters of FreeImage tone mapping operators and the range of the linear operator.
+ */
+class ToneMapping
+{
+public:
+    /**
+     * Description of a tunable operator parameter, for building controls
+     */
+    struct Parameter
+    {
+        const char* name;
+        double min;
+        double max;
+        double defaultValue;
+    };
+
+    /**
+     * Parameters passed as first and second arguments of FreeImage_ToneMapping(), in this order.
+     * Empty for operators without parameters.
+     */
+    static std::vector<Parameter> parameters(FREE_IMAGE_TMO mode);
+
+    /**
+     * Luminance range mapped to [0, 1] by the linear operator, for applying the operator elsewhere.
+     * Returns false for constant images.
+     */
+    static bool linearRange(FIBITMAP* src, float* low, float* high);
+};
+
+#endif // TONEMAPPING_H
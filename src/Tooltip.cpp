@@ -45,6 +45,11 @@ void Tooltip::show()
     mTextWidget->update();
 }
 
+bool Tooltip::isVisible() const
+{
+    return mTextWidget->isVisible();
+}
+
 void Tooltip::hide()
 {
     mTextWidget->hide();
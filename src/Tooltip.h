@@ -46,6 +46,8 @@ public:
 
     void show();
 
+    bool isVisible() const;
+
     void setText(const QVector<QString>& lines);
 
     void move(const QPoint& position);
@@ -0,0 +1,141 @@
+/**
+ * @file
+ *
+ * Copyright 2018-2026 Alexey Gruzdev
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ViewAnimation.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr double kZoomDuration = 0.15;
+
+    // Velocity is measured over the last part of the drag
+    constexpr double kPanSampleWindow = 0.1;
+    // Time constant of the exponential slowdown
+    constexpr double kPanDecay = 0.325;
+    // Pixels per second
+    constexpr double kPanMinSpeed = 20.0;
+    // Drag which stopped before the release doesn't continue
+    constexpr double kPanMaxHold = 0.05;
+
+    double seconds(ViewAnimation::Clock::duration d)
+    {
+        return std::chrono::duration<double>(d).count();
+    }
+
+    double length(const QPointF& p)
+    {
+        return std::hypot(p.x(), p.y());
+    }
+}
+
+void ViewAnimation::startZoom(const QRectF& from, const QRectF& to, Clock::time_point now)
+{
+    mPanning = false;
+    mZooming = !from.isEmpty() && !to.isEmpty() && from != to;
+    mZoomFrom = from;
+    mZoomTo = to;
+    mZoomStart = now;
+}
+
+QRectF ViewAnimation::zoomRect(Clock::time_point now) const
+{
+    const double t = std::clamp(seconds(now - mZoomStart) / kZoomDuration, 0.0, 1.0);
+    if (!mZooming || t >= 1.0) {
+        return mZoomTo;
+    }
+    // Ease out, the size changes geometrically so that every zoom step takes the same time
+    const double e = 1.0 - std::pow(1.0 - t, 3.0);
+    const double w0 = mZoomFrom.width();
+    const double w1 = mZoomTo.width();
+    const double w = w0 * std::pow(w1 / w0, e);
+    // Edges of an anchored zoom are linear in the width, so the anchor stays in place
+    const double u = (w1 != w0) ? (w - w0) / (w1 - w0) : e;
+    const auto lerp = [u](double a, double b) { return a + (b - a) * u; };
+    return QRectF(lerp(mZoomFrom.left(), mZoomTo.left()), lerp(mZoomFrom.top(), mZoomTo.top()),
+        lerp(mZoomFrom.width(), mZoomTo.width()), lerp(mZoomFrom.height(), mZoomTo.height()));
+}
+
+void ViewAnimation::trackPan(const QPoint& pos, Clock::time_point now)
+{
+    mPanSamples.erase(std::remove_if(mPanSamples.begin(), mPanSamples.end(), [&](const PanSample& s) {
+        return seconds(now - s.time) > kPanSampleWindow;
+    }), mPanSamples.end());
+    mPanSamples.push_back({ QPointF(pos), now });
+}
+
+bool ViewAnimation::startPan(Clock::time_point now)
+{
+    mPanning = false;
+    trackPan(mPanSamples.empty() ? QPoint() : mPanSamples.back().pos.toPoint(), now);
+    if (mPanSamples.size() > 2) {
+        const PanSample& first = mPanSamples.front();
+        // The release sample repeats the last position
+        const PanSample& last = mPanSamples[mPanSamples.size() - 2];
+        const double dt = seconds(last.time - first.time);
+        if (dt > 0.0 && seconds(now - last.time) < kPanMaxHold) {
+            mPanVelocity = (last.pos - first.pos) / dt;
+            mPanning = length(mPanVelocity) > kPanMinSpeed;
+        }
+    }
+    mPanSamples.clear();
+    if (mPanning) {
+        mZooming = false;
+        mPanTravelled = QPointF();
+        mPanApplied = QPointF();
+        mPanStart = now;
+    }
+    return mPanning;
+}
+
+QPoint ViewAnimation::panStep(Clock::time_point now)
+{
+    if (!mPanning) {
+        return QPoint();
+    }
+    const double t = seconds(now - mPanStart);
+    const double decay = std::exp(-t / kPanDecay);
+    mPanTravelled = mPanVelocity * (kPanDecay * (1.0 - decay));
+    if (length(mPanVelocity) * decay < kPanMinSpeed) {
+        mPanning = false;
+    }
+    // Fractions are kept for the next step
+    const QPoint step = (mPanTravelled - mPanApplied).toPoint();
+    mPanApplied += QPointF(step);
+    return step;
+}
+
+void ViewAnimation::advance(Clock::time_point now)
+{
+    if (mZooming && seconds(now - mZoomStart) >= kZoomDuration) {
+        mZooming = false;
+    }
+}
+
+void ViewAnimation::stopPan()
+{
+    mPanning = false;
+    mPanSamples.clear();
+}
+
+void ViewAnimation::stop()
+{
+    mZooming = false;
+    stopPan();
+}
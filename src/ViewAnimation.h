@@ -0,0 +1,107 @@
+/**
+ * @file
+ *
+ * Copyright 2018-2026 Alexey Gruzdev
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VIEWANIMATION_H
+#define VIEWANIMATION_H
+
+#include <chrono>
+#include <vector>
+
+#include <QPoint>
+#include <QPointF>
+#include <QRectF>
+
+/**
+ * Animated zoom transitions and inertial panning of the canvas view.
+ * State is a function of time, so frames can be dropped without changing the speed of the motion.
+ */
+class ViewAnimation
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * Starts transition of the displayed image rectangle, the previous transition is replaced
+     */
+    void startZoom(const QRectF& from, const QRectF& to, Clock::time_point now);
+
+    bool isZooming() const
+    {
+        return mZooming;
+    }
+
+    /**
+     * Displayed image rectangle of the transition at the time
+     */
+    QRectF zoomRect(Clock::time_point now) const;
+
+    /**
+     * Records position of the dragged view for the release velocity
+     */
+    void trackPan(const QPoint& pos, Clock::time_point now);
+
+    /**
+     * Continues the drag with the release velocity. Returns false if the view was not moving.
+     */
+    bool startPan(Clock::time_point now);
+
+    bool isPanning() const
+    {
+        return mPanning;
+    }
+
+    /**
+     * Offset of the view since the previous step, in whole pixels
+     */
+    QPoint panStep(Clock::time_point now);
+
+    /**
+     * Finishes the transitions which are over
+     */
+    void advance(Clock::time_point now);
+
+    bool isActive() const
+    {
+        return mZooming || mPanning;
+    }
+
+    void stopPan();
+
+    void stop();
+
+private:
+    struct PanSample
+    {
+        QPointF pos;
+        Clock::time_point time;
+    };
+
+    bool mZooming = false;
+    QRectF mZoomFrom;
+    QRectF mZoomTo;
+    Clock::time_point mZoomStart;
+
+    std::vector<PanSample> mPanSamples;
+    bool mPanning = false;
+    QPointF mPanVelocity;
+    QPointF mPanTravelled;
+    QPointF mPanApplied;
+    Clock::time_point mPanStart;
+};
+
+#endif // VIEWANIMATION_H
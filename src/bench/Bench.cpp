@@ -0,0 +1,233 @@
+/**
+ * @file
+ *
+ * Copyright 2018-2026 Alexey Gruzdev
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Bench.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+    uint32_t hash(uint32_t x, uint32_t y)
+    {
+        uint32_t h = x * 0x8da6b343u ^ y * 0xd8163841u;
+        h ^= h >> 13;
+        h *= 0x85ebca6bu;
+        h ^= h >> 16;
+        return h;
+    }
+
+    float sceneLuminance(uint32_t x, uint32_t y, uint32_t width, uint32_t height)
+    {
+        const float u = (x + 0.5f) / width;
+        const float v = (y + 0.5f) / height;
+        // Sky gradient with texture and fine grain
+        float lum = (0.05f + 0.95f * v) * (0.6f + 0.4f * std::sin(40.0f * u) * std::sin(30.0f * v));
+        lum *= 0.9f + 0.2f * (hash(x, y) & 0xFFFF) / 65535.0f;
+        // Deep shadow in the lower left corner
+        if (u < 0.4f && v < 0.3f) {
+            lum *= 0.002f;
+        }
+        // Lamps and the sun
+        const float du = std::fmod(u * 8.0f, 1.0f) - 0.5f;
+        const float dv = std::fmod(v * 6.0f, 1.0f) - 0.5f;
+        lum += 100.0f * std::exp(-(du * du + dv * dv) * 400.0f);
+        const float su = u - 0.7f;
+        const float sv = v - 0.75f;
+        lum += 2.0e4f * std::exp(-(su * su + sv * sv) * 2000.0f);
+        return lum;
+    }
+
+    FIBITMAP* to24Bits(FIBITMAP* dib)
+    {
+        if (FreeImage_GetImageType(dib) == FIT_BITMAP && FreeImage_GetBPP(dib) == 24) {
+            return FreeImage_Clone(dib);
+        }
+        return FreeImage_ConvertTo24Bits(dib);
+    }
+}
+
+FIBITMAP* Bench::makeHdrBitmap(FREE_IMAGE_TYPE type, uint32_t width, uint32_t height)
+{
+    uint32_t bpp = 0;
+    switch (type) {
+    case FIT_FLOAT:
+        bpp = 32;
+        break;
+    case FIT_RGBF:
+        bpp = 96;
+        break;
+    case FIT_RGBAF:
+        bpp = 128;
+        break;
+    default:
+        throw std::logic_error("Bench[makeHdrBitmap]: Unsupported type.");
+    }
+    FIBITMAP* dib = FreeImage_AllocateT(type, width, height, bpp);
+    if (!dib) {
+        throw std::runtime_error("Bench[makeHdrBitmap]: Failed to allocate bitmap.");
+    }
+    for (uint32_t y = 0; y < height; ++y) {
+        uint8_t* line = FreeImage_GetScanLine(dib, y);
+        for (uint32_t x = 0; x < width; ++x) {
+            const float lum = sceneLuminance(x, y, width, height);
+            const float tint = static_cast<float>(x) / width;
+            switch (type) {
+            case FIT_FLOAT:
+                reinterpret_cast<float*>(line)[x] = lum;
+                break;
+            case FIT_RGBF: {
+                    FIRGBF& pixel = reinterpret_cast<FIRGBF*>(line)[x];
+                    pixel.red   = lum * (0.8f + 0.4f * tint);
+                    pixel.green = lum;
+                    pixel.blue  = lum * (1.2f - 0.4f * tint);
+                }
+                break;
+            default: {
+                    FIRGBAF& pixel = reinterpret_cast<FIRGBAF*>(line)[x];
+                    pixel.red   = lum * (0.8f + 0.4f * tint);
+                    pixel.green = lum;
+                    pixel.blue  = lum * (1.2f - 0.4f * tint);
+                    pixel.alpha = 1.0f;
+                }
+                break;
+            }
+        }
+    }
+    return dib;
+}
+
+QImage Bench::makeImage(int width, int height)
+{
+    QImage image(width, height, QImage::Format_RGB888);
+    if (image.isNull()) {
+        throw std::runtime_error("Bench[makeImage]: Failed to allocate image.");
+    }
+    for (int y = 0; y < height; ++y) {
+        uchar* line = image.scanLine(y);
+        for (int x = 0; x < width; ++x) {
+            const bool grid = (x % 7 == 0) || (y % 5 == 0);
+            line[3 * x]     = grid ? 255 : static_cast<uchar>(255 * x / width);
+            line[3 * x + 1] = grid ? 255 : static_cast<uchar>(255 * y / height);
+            line[3 * x + 2] = static_cast<uchar>((x * 31 + y * 17) & 0xFF);
+        }
+    }
+    return image;
+}
+
+FIBITMAP* Bench::toBitmap(const QImage& image)
+{
+    if (image.format() != QImage::Format_RGB888) {
+        throw std::logic_error("Bench[toBitmap]: Image must be RGB888.");
+    }
+    FIBITMAP* dib = FreeImage_Allocate(image.width(), image.height(), 24);
+    if (!dib) {
+        throw std::runtime_error("Bench[toBitmap]: Failed to allocate bitmap.");
+    }
+    for (int y = 0; y < image.height(); ++y) {
+        std::memcpy(FreeImage_GetScanLine(dib, image.height() - 1 - y), image.constScanLine(y), 3 * static_cast<size_t>(image.width()));
+    }
+    return dib;
+}
+
+Bench::Error Bench::compare(FIBITMAP* lhs, FIBITMAP* rhs)
+{
+    if (!lhs || !rhs) {
+        throw std::logic_error("Bench[compare]: Null bitmap.");
+    }
+    const uint32_t width  = FreeImage_GetWidth(lhs);
+    const uint32_t height = FreeImage_GetHeight(lhs);
+    if (width != FreeImage_GetWidth(rhs) || height != FreeImage_GetHeight(rhs)) {
+        throw std::logic_error("Bench[compare]: Bitmaps have different sizes.");
+    }
+    UniqueBitmap lhs24(nullptr, &::FreeImage_Unload);
+    UniqueBitmap rhs24(nullptr, &::FreeImage_Unload);
+    if (FreeImage_GetImageType(lhs) != FIT_BITMAP || FreeImage_GetImageType(rhs) != FIT_BITMAP) {
+        throw std::logic_error("Bench[compare]: Only 8 bit bitmaps are compared.");
+    }
+    if (FreeImage_GetBPP(lhs) != FreeImage_GetBPP(rhs) || FreeImage_GetBPP(lhs) < 24) {
+        lhs24.reset(to24Bits(lhs));
+        rhs24.reset(to24Bits(rhs));
+        if (!lhs24 || !rhs24) {
+            throw std::runtime_error("Bench[compare]: Failed to convert bitmaps.");
+        }
+        lhs = lhs24.get();
+        rhs = rhs24.get();
+    }
+    const uint32_t rowBytes = width * FreeImage_GetBPP(lhs) / 8;
+    Error error;
+    double sum = 0.0;
+    for (uint32_t y = 0; y < height; ++y) {
+        const uint8_t* lhsLine = FreeImage_GetScanLine(lhs, y);
+        const uint8_t* rhsLine = FreeImage_GetScanLine(rhs, y);
+        for (uint32_t i = 0; i < rowBytes; ++i) {
+            const double diff = std::abs(static_cast<int>(lhsLine[i]) - static_cast<int>(rhsLine[i]));
+            error.max = std::max(error.max, diff);
+            sum += diff;
+        }
+    }
+    error.mean = sum / (static_cast<double>(rowBytes) * height);
+    return error;
+}
+
+
+int main(int argc, char* argv[])
+try
+{
+    struct Suite
+    {
+        const char* name;
+        void (*run)();
+    };
+    const Suite suites[] = {
+        { "rowkernels", &runRowKernelsBench },
+        { "pixeltraits", &runPixelTraitsBench },
+        { "resampler", &runResamplerBench },
+        { "canvas", &runCanvasBench },
+    };
+
+    for (int i = 1; i < argc; ++i) {
+        const bool known = std::any_of(std::begin(suites), std::end(suites), [&](const Suite& suite) { return std::strcmp(suite.name, argv[i]) == 0; });
+        if (!known) {
+            std::printf("Usage: ShibaBench [suite...]\nSuites:");
+            for (const auto& suite : suites) {
+                std::printf(" %s", suite.name);
+            }
+            std::printf("\n");
+            return 1;
+        }
+    }
+#ifndef NDEBUG
+    std::printf("Assertions are enabled, build with CMAKE_BUILD_TYPE=Release for representative timings\n\n");
+#endif
+    for (const auto& suite : suites) {
+        const bool selected = (argc < 2) || std::any_of(argv + 1, argv + argc, [&](const char* arg) { return std::strcmp(suite.name, arg) == 0; });
+        if (selected) {
+            std::printf("== %s\n", suite.name);
+            suite.run();
+            std::printf("\n");
+        }
+    }
+    return 0;
+}
+catch (std::exception& err) {
+    std::fprintf(stderr, "ShibaBench: %s\n", err.what());
+    return 1;
+}
@@ -0,0 +1,103 @@
+/**
+ * @file
+ *
+ * Copyright 2018-2026 Alexey Gruzdev
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include <QImage>
+#include "FreeImageExt.h"
+
+/**
+ * Helpers shared by the suites of ShibaBench
+ */
+class Bench
+{
+public:
+    /**
+     * Difference of 8 bit results in levels over all channels
+     */
+    struct Error
+    {
+        double max  = 0.0;
+        double mean = 0.0;
+    };
+
+    /**
+     * Median time of repeated calls in milliseconds, measured after one warm up call
+     */
+    template <typename Fn_>
+    static double measure(Fn_&& fn, uint32_t repeats = 5)
+    {
+        fn();
+        std::vector<double> times(std::max(repeats, 1u));
+        for (auto& time : times) {
+            const auto start = std::chrono::steady_clock::now();
+            fn();
+            time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+        std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+        return times[times.size() / 2];
+    }
+
+    /**
+     * Deterministic scene with smooth gradients, texture and highlights spanning six orders of magnitude.
+     * Type is FIT_FLOAT, FIT_RGBF or FIT_RGBAF.
+     */
+    static FIBITMAP* makeHdrBitmap(FREE_IMAGE_TYPE type, uint32_t width, uint32_t height);
+
+    /**
+     * RGB888 gradients under a one pixel grid, which aliases if a filter skips source pixels
+     */
+    static QImage makeImage(int width, int height);
+
+    /**
+     * 24 bit bottom-up copy of the RGB888 image
+     */
+    static FIBITMAP* toBitmap(const QImage& image);
+
+    /**
+     * Compares bitmaps of the same size. Bitmaps with different bpp are compared as 24 bit.
+     */
+    static Error compare(FIBITMAP* lhs, FIBITMAP* rhs);
+};
+
+/**
+ * RowKernels conversions against scalar loops, in cache and in memory
+ */
+void runRowKernelsBench();
+
+/**
+ * Loops compiled per format by visitPixels() against a type switch per pixel
+ */
+void runPixelTraitsBench();
+
+/**
+ * Resampler::area() against FreeImage_Rescale() and QImage::scaled()
+ */
+void runResamplerBench();
+
+/**
+ * Frame times of the OpenGL and raster canvas backends for a scripted zoom and pan
+ */
+void runCanvasBench();
+
+#endif // BENCH_H
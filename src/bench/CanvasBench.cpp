@@ -0,0 +1,159 @@
+/**
+ * @file
+ *
+ * Copyright 2018-2026 Alexey Gruzdev
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Bench.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <future>
+#include <vector>
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QPainter>
+#include <QPixmap>
+#include "GLCanvas.h"
+#include "MipPyramid.h"
+
+namespace
+{
+    constexpr int kFrames = 240;
+    constexpr int kWindowWidth  = 1920;
+    constexpr int kWindowHeight = 1080;
+
+    struct View
+    {
+        // Image rectangle centered at zero, as CanvasWidget passes it to both backends
+        QRectF target;
+        QTransform transform;
+        qreal scale = 1.0;
+    };
+
+    /**
+     * Zoom from fit to 1:1 while the center moves along a widening circle, as a wheel zoom with a drag
+     */
+    View scriptedView(int frame, const QSize& imageSize)
+    {
+        const qreal t = static_cast<qreal>(frame) / (kFrames - 1);
+        const qreal fit = std::min(static_cast<qreal>(kWindowWidth) / imageSize.width(), static_cast<qreal>(kWindowHeight) / imageSize.height());
+        View view;
+        view.scale = fit + (1.0 - fit) * t;
+        const QSizeF size = QSizeF(imageSize) * view.scale;
+        view.target = QRectF(-0.5 * size.width(), -0.5 * size.height(), size.width(), size.height());
+        const qreal angle = 4.0 * 3.14159265358979 * t;
+        const qreal radius = 0.25 * kWindowHeight * t;
+        view.transform = QTransform::fromTranslate(0.5 * kWindowWidth + radius * std::cos(angle), 0.5 * kWindowHeight + radius * std::sin(angle));
+        return view;
+    }
+
+    QPixmap makeCheckerboard()
+    {
+        // Same as the pattern of CanvasWidget
+        QPixmap pixmap(16, 16);
+        QPainter painter(&pixmap);
+        painter.fillRect(0, 0, 8, 8, QColor(Qt::lightGray));
+        painter.fillRect(8, 0, 8, 8, QColor(Qt::white));
+        painter.fillRect(8, 8, 8, 8, QColor(Qt::lightGray));
+        painter.fillRect(0, 8, 8, 8, QColor(Qt::white));
+        return pixmap;
+    }
+
+    void printTimes(const char* backend, std::vector<double> times)
+    {
+        std::sort(times.begin(), times.end());
+        double sum = 0.0;
+        for (const double time : times) {
+            sum += time;
+        }
+        std::printf("%-28s %10.3f %10.3f %10.3f %10.3f\n", backend, sum / times.size(), times[times.size() / 2], times[times.size() * 95 / 100], times.back());
+    }
+}
+
+void runCanvasBench()
+{
+    // Widgets need the application, which isn't required by other suites
+    int argc = 1;
+    char name[] = "ShibaBench";
+    char* argv[] = { name, nullptr };
+    QApplication app(argc, argv);
+
+    const QImage image = Bench::makeImage(7680, 4320);
+    UniqueBitmap frame(Bench::toBitmap(image), &::FreeImage_Unload);
+    const QPixmap pixmap = QPixmap::fromImage(image);
+    const QPixmap checkerboard = makeCheckerboard();
+    const QColor background(0x30, 0x30, 0x30);
+
+    std::printf("%d frames of zoom from fit to 1:1 with pan, %dx%d image in a %dx%d window, smooth filtering and checkerboard\n",
+        kFrames, image.width(), image.height(), kWindowWidth, kWindowHeight);
+    std::printf("%-28s %10s %10s %10s %10s\n", "backend, ms per frame", "mean", "median", "p95", "max");
+
+    // Raster path of a moving view: the closest mip level is drawn over the checkerboard without tiles
+    MipPyramid pyramid;
+    std::promise<void> built;
+    pyramid.build(pixmap.cacheKey(), image, [&built]() { built.set_value(); });
+    built.get_future().wait();
+    QImage surface(kWindowWidth, kWindowHeight, QImage::Format_RGB32);
+    std::vector<double> rasterTimes;
+    for (int i = 0; i < kFrames; ++i) {
+        const View view = scriptedView(i, image.size());
+        QElapsedTimer timer;
+        timer.start();
+        {
+            const QPixmap level = pyramid.level(view.scale);
+            const QPixmap& source = level.isNull() ? pixmap : level;
+            QPainter painter(&surface);
+            painter.setRenderHint(QPainter::RenderHint::SmoothPixmapTransform, true);
+            painter.fillRect(surface.rect(), background);
+            painter.drawTiledPixmap(view.transform.mapRect(view.target).toAlignedRect().intersected(surface.rect()), checkerboard);
+            painter.setTransform(view.transform);
+            painter.drawPixmap(view.target, source, QRectF(source.rect()));
+        }
+        rasterTimes.push_back(timer.nsecsElapsed() / 1e6);
+    }
+    printTimes("raster", std::move(rasterTimes));
+
+    // OpenGL path draws the unprocessed frame, which is uploaded once
+    GLCanvas canvas(nullptr);
+    canvas.resize(kWindowWidth, kWindowHeight);
+    canvas.setMeasureTime(true);
+    canvas.setBackground(background, true);
+    canvas.setProcessing(GLCanvas::Processing{});
+    // Grabbing initializes the context of a hidden widget
+    canvas.grabFramebuffer();
+    QElapsedTimer uploadTimer;
+    uploadTimer.start();
+    if (!canvas.setFrame(1, frame.get())) {
+        std::printf("OpenGL canvas is not available, only the raster path is measured\n");
+        return;
+    }
+    const double uploadTime = uploadTimer.nsecsElapsed() / 1e6;
+    std::vector<double> paintTimes;
+    std::vector<double> grabTimes;
+    for (int i = 0; i < kFrames; ++i) {
+        const View view = scriptedView(i, image.size());
+        canvas.setView(view.target, view.transform, true);
+        QElapsedTimer timer;
+        timer.start();
+        canvas.grabFramebuffer();
+        grabTimes.push_back(timer.nsecsElapsed() / 1e6);
+        paintTimes.push_back(canvas.paintTime());
+    }
+    printTimes("OpenGL, paint until finish", std::move(paintTimes));
+    printTimes("OpenGL, paint and readback", std::move(grabTimes));
+    std::printf("OpenGL texture upload: %.3f ms\n", uploadTime);
+}
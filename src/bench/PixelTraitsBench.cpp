@@ -0,0 +1,152 @@
+/**
+ * @file
+ *
+ * Copyright 2018-2026 Alexey Gruzdev
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Bench.h"
+
+#include <cstdio>
+#include <stdexcept>
+#include "PixelTraits.h"
+#include "RowKernels.h"
+
+namespace
+{
+    constexpr uint32_t kWidth  = 3840;
+    constexpr uint32_t kHeight = 2160;
+
+    struct Planes
+    {
+        std::vector<float> r;
+        std::vector<float> g;
+        std::vector<float> b;
+    };
+
+    /**
+     * Type switch per pixel, as ToneMapping read frames before PixelTraits
+     */
+    void loadSwitched(FIBITMAP* src, Planes* planes)
+    {
+        const auto type = FreeImage_GetImageType(src);
+        const bool half = FreeImageExt_IsHalf(src);
+        const uint32_t width  = FreeImage_GetWidth(src);
+        const uint32_t height = FreeImage_GetHeight(src);
+        for (uint32_t y = 0; y < height; ++y) {
+            const uint8_t* line = FreeImage_GetScanLine(src, static_cast<int>(y));
+            float* r = planes->r.data() + static_cast<size_t>(y) * width;
+            float* g = planes->g.data() + static_cast<size_t>(y) * width;
+            float* b = planes->b.data() + static_cast<size_t>(y) * width;
+            if (half) {
+                const uint16_t* p = reinterpret_cast<const uint16_t*>(line);
+                const uint32_t channels = FreeImage_GetBPP(src) / 16;
+                for (uint32_t x = 0; x < width; ++x, p += channels) {
+                    r[x] = RowKernels::halfToFloat(p[0]);
+                    g[x] = (channels > 1) ? RowKernels::halfToFloat(p[1]) : r[x];
+                    b[x] = (channels > 1) ? RowKernels::halfToFloat(p[2]) : r[x];
+                }
+                continue;
+            }
+            for (uint32_t x = 0; x < width; ++x) {
+                switch (type) {
+                case FIT_FLOAT:
+                    r[x] = g[x] = b[x] = reinterpret_cast<const float*>(line)[x];
+                    break;
+                case FIT_RGBF: {
+                        const auto& p = reinterpret_cast<const FIRGBF*>(line)[x];
+                        r[x] = p.red;
+                        g[x] = p.green;
+                        b[x] = p.blue;
+                    }
+                    break;
+                default: {
+                        const auto& p = reinterpret_cast<const FIRGBAF*>(line)[x];
+                        r[x] = p.red;
+                        g[x] = p.green;
+                        b[x] = p.blue;
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    /**
+     * Same loop as ToneMapping compiled per format by visitPixels()
+     */
+    void loadVisited(FIBITMAP* src, Planes* planes)
+    {
+        const uint32_t width  = FreeImage_GetWidth(src);
+        const uint32_t height = FreeImage_GetHeight(src);
+        visitPixels(pixelFormat(src), [&](auto traits) {
+            using Traits = decltype(traits);
+            for (uint32_t y = 0; y < height; ++y) {
+                const uint8_t* line = FreeImage_GetScanLine(src, static_cast<int>(y));
+                float* r = planes->r.data() + static_cast<size_t>(y) * width;
+                float* g = planes->g.data() + static_cast<size_t>(y) * width;
+                float* b = planes->b.data() + static_cast<size_t>(y) * width;
+                for (uint32_t x = 0; x < width; ++x) {
+                    if (Traits::kChannels == 1) {
+                        r[x] = g[x] = b[x] = Traits::red(line, x);
+                    }
+                    else {
+                        r[x] = Traits::red(line, x);
+                        g[x] = Traits::green(line, x);
+                        b[x] = Traits::blue(line, x);
+                    }
+                }
+            }
+        });
+    }
+
+    /**
+     * Half precision copy of the frame, values are rounded first so the conversion is exact
+     */
+    FIBITMAP* makeHalfBitmap(FIBITMAP* src)
+    {
+        const uint32_t rowSize = FreeImage_GetWidth(src) * FreeImage_GetBPP(src) / 32;
+        std::vector<uint16_t> buffer(rowSize);
+        for (uint32_t y = 0; y < FreeImage_GetHeight(src); ++y) {
+            float* line = reinterpret_cast<float*>(FreeImage_GetScanLine(src, static_cast<int>(y)));
+            RowKernels::floatToHalf(line, buffer.data(), rowSize);
+            RowKernels::halfToFloat(buffer.data(), line, rowSize);
+        }
+        return FreeImageExt_ConvertToHalf(src);
+    }
+}
+
+void runPixelTraitsBench()
+{
+    const size_t pixels = static_cast<size_t>(kWidth) * kHeight;
+    Planes switched{ std::vector<float>(pixels), std::vector<float>(pixels), std::vector<float>(pixels) };
+    Planes visited = switched;
+
+    std::printf("Single thread loading of %ux%u frames into float planes, ns per pixel\n", kWidth, kHeight);
+    std::printf("%-20s %12s %12s %8s %6s\n", "format", "switch", "traits", "speedup", "same");
+    for (const auto type : { FIT_FLOAT, FIT_RGBF, FIT_RGBAF }) {
+        UniqueBitmap frame(Bench::makeHdrBitmap(type, kWidth, kHeight), &::FreeImage_Unload);
+        UniqueBitmap half(makeHalfBitmap(frame.get()), &::FreeImage_Unload);
+        if (!half) {
+            throw std::runtime_error("PixelTraitsBench: Failed to convert frame to half precision.");
+        }
+        for (FIBITMAP* src : { frame.get(), half.get() }) {
+            const double switchedTime = Bench::measure([&]() { loadSwitched(src, &switched); });
+            const double visitedTime  = Bench::measure([&]() { loadVisited(src, &visited); });
+            const bool same = (switched.r == visited.r && switched.g == visited.g && switched.b == visited.b);
+            std::printf("%-20s %12.3f %12.3f %8.2f %6s\n", FreeImageExt_DescribeImageType(src), 1.0e6 * switchedTime / pixels, 1.0e6 * visitedTime / pixels,
+                switchedTime / visitedTime, same ? "yes" : "no");
+        }
+    }
+}
@@ -0,0 +1,77 @@
+/**
+ * @file
+ *
+ * Copyright 2018-2026 Alexey Gruzdev
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Bench.h"
+
+#include <cstdio>
+#include <stdexcept>
+#include <QImage>
+#include "Resampler.h"
+
+namespace
+{
+    Bench::Error compareImages(const QImage& reference, const QImage& image)
+    {
+        UniqueBitmap lhs(Bench::toBitmap(reference.convertToFormat(QImage::Format_RGB888)), &::FreeImage_Unload);
+        UniqueBitmap rhs(Bench::toBitmap(image.convertToFormat(QImage::Format_RGB888)), &::FreeImage_Unload);
+        return Bench::compare(lhs.get(), rhs.get());
+    }
+
+    void printRow(const char* method, const QSize& size, double time, const Bench::Error& error)
+    {
+        char sizeText[32];
+        std::snprintf(sizeText, sizeof(sizeText), "%dx%d", size.width(), size.height());
+        std::printf("%-22s %-10s %10.2f %6.0f %8.4f\n", method, sizeText, time, error.max, error.mean);
+    }
+}
+
+void runResamplerBench()
+{
+    const QImage image = Bench::makeImage(7680, 4320);
+    UniqueBitmap bitmap(Bench::toBitmap(image), &::FreeImage_Unload);
+    const std::atomic<bool> cancelled{ false };
+
+    struct Filter
+    {
+        const char* name;
+        FREE_IMAGE_FILTER filter;
+    };
+    const Filter filters[] = { { "FreeImage box", FILTER_BOX }, { "FreeImage bilinear", FILTER_BILINEAR }, { "FreeImage lanczos3", FILTER_LANCZOS3 } };
+
+    std::printf("Downscaling of %dx%d RGB888, only Resampler is parallel. Difference is to the exact area average.\n", image.width(), image.height());
+    std::printf("%-22s %-10s %10s %6s %8s\n", "method", "size", "ms", "max", "mean");
+    for (const QSize size : { QSize(3840, 2160), QSize(1920, 1080), QSize(1366, 768) }) {
+        QImage reference;
+        const double areaTime = Bench::measure([&]() { reference = Resampler::area(image, size, cancelled); });
+        printRow("Resampler::area", size, areaTime, Bench::Error{});
+
+        QImage scaled;
+        const double scaledTime = Bench::measure([&]() { scaled = image.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation); });
+        printRow("QImage::scaled smooth", size, scaledTime, compareImages(reference, scaled));
+
+        for (const auto& filter : filters) {
+            UniqueBitmap rescaled(nullptr, &::FreeImage_Unload);
+            const double rescaleTime = Bench::measure([&]() { rescaled.reset(FreeImage_Rescale(bitmap.get(), size.width(), size.height(), filter.filter)); });
+            if (!rescaled) {
+                throw std::runtime_error("ResamplerBench: FreeImage_Rescale failed.");
+            }
+            UniqueBitmap expected(Bench::toBitmap(reference), &::FreeImage_Unload);
+            printRow(filter.name, size, rescaleTime, Bench::compare(expected.get(), rescaled.get()));
+        }
+    }
+}
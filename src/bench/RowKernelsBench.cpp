@@ -0,0 +1,148 @@
+/**
+ * @file
+ *
+ * Copyright 2018-2026 Alexey Gruzdev
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Bench.h"
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include "Gamma.h"
+#include "RowKernels.h"
+
+namespace
+{
+    // Row fits L1/L2, frame is far larger than the last level cache
+    constexpr uint32_t kRowPixels   = 4096;
+    constexpr uint32_t kRowRepeats  = 2000;
+    constexpr uint32_t kFramePixels = 3840 * 2160;
+
+    uint8_t scalarToByte(float v, float gamma)
+    {
+        if (gamma != 1.0f) {
+            v = (v > 0.0f) ? Gamma::fastPow(v, gamma) : 0.0f;
+        }
+        const float s = 256.0f * v;
+        return (s > 0.0f) ? ((s < 255.0f) ? static_cast<uint8_t>(s) : 255) : 0;
+    }
+
+    void scalarFloatToBytes(const float* src, uint32_t channels, uint8_t* dst, uint32_t count, float gamma)
+    {
+        for (uint32_t i = 0; i < channels * count; ++i) {
+            const bool alpha = (channels == 4) && ((i & 3) == 3);
+            dst[i] = scalarToByte(src[i], alpha ? 1.0f : gamma);
+        }
+    }
+
+    void scalarHalfToBytes(const uint16_t* src, uint32_t channels, uint8_t* dst, uint32_t count, float gamma)
+    {
+        for (uint32_t i = 0; i < channels * count; ++i) {
+            const bool alpha = (channels == 4) && ((i & 3) == 3);
+            dst[i] = scalarToByte(RowKernels::halfToFloat(src[i]), alpha ? 1.0f : gamma);
+        }
+    }
+
+    void scalarHalfToFloat(const uint16_t* src, float* dst, uint32_t count)
+    {
+        for (uint32_t i = 0; i < count; ++i) {
+            dst[i] = RowKernels::halfToFloat(src[i]);
+        }
+    }
+
+    /**
+     * Runs the conversion either as repeated passes over one row or as one pass over a frame
+     */
+    template <typename Fn_>
+    double throughput(uint32_t items, uint32_t repeats, size_t bytesPerItem, Fn_&& fn)
+    {
+        const double ms = Bench::measure([&]() {
+            for (uint32_t r = 0; r < repeats; ++r) {
+                fn();
+            }
+        });
+        return static_cast<double>(bytesPerItem) * items * repeats / (ms * 1.0e6);
+    }
+
+    void printRow(const char* kernel, uint32_t channels, float gamma, const char* set, double scalar, double vector, uint32_t maxDiff)
+    {
+        std::printf("%-14s %8u %6.2f %-6s %12.2f %14.2f %8.2f %8u\n", kernel, channels, gamma, set, scalar, vector, vector / scalar, maxDiff);
+    }
+
+    uint32_t maxDifference(const std::vector<uint8_t>& lhs, const std::vector<uint8_t>& rhs)
+    {
+        uint32_t diff = 0;
+        for (size_t i = 0; i < lhs.size(); ++i) {
+            diff = std::max<uint32_t>(diff, std::abs(static_cast<int>(lhs[i]) - static_cast<int>(rhs[i])));
+        }
+        return diff;
+    }
+}
+
+void runRowKernelsBench()
+{
+    std::mt19937 random(42);
+    // Slightly above 1 to exercise clamping
+    std::uniform_real_distribution<float> distribution(0.0f, 1.2f);
+    std::vector<float> floats(4 * static_cast<size_t>(kFramePixels));
+    for (auto& v : floats) {
+        v = distribution(random);
+    }
+    std::vector<uint16_t> halves(floats.size());
+    RowKernels::floatToHalf(floats.data(), halves.data(), static_cast<uint32_t>(floats.size()));
+    std::vector<uint8_t> bytes(floats.size());
+    std::vector<uint8_t> reference(floats.size());
+    std::vector<float> expanded(floats.size());
+    std::vector<float> expandedReference(floats.size());
+
+    std::printf("Single thread throughput in GB/s of read and written bytes\n");
+    {
+        const size_t frameBytes = 4 * sizeof(float) * static_cast<size_t>(kFramePixels);
+        const double ms = Bench::measure([&]() { std::memcpy(expanded.data(), floats.data(), frameBytes); });
+        std::printf("memcpy of a frame, the bandwidth bound: %.2f GB/s\n\n", 2.0 * frameBytes / (ms * 1.0e6));
+    }
+
+    std::printf("%-14s %8s %6s %-6s %12s %14s %8s %8s\n", "kernel", "channels", "gamma", "set", "scalar GB/s", "RowKernels GB/s", "speedup", "max diff");
+    struct Set
+    {
+        const char* name;
+        uint32_t pixels;
+        uint32_t repeats;
+    };
+    const Set sets[] = { { "row", kRowPixels, kRowRepeats }, { "frame", kFramePixels, 1 } };
+    for (const auto& set : sets) {
+        for (const uint32_t channels : { 1u, 3u, 4u }) {
+            const uint32_t count = set.pixels * 4 / channels;
+            for (const float gamma : { 1.0f, 1.0f / 2.2f }) {
+                const size_t floatBytes = channels * (sizeof(float) + 1);
+                const double scalar = throughput(count, set.repeats, floatBytes, [&]() { scalarFloatToBytes(floats.data(), channels, reference.data(), count, gamma); });
+                const double vector = throughput(count, set.repeats, floatBytes, [&]() { RowKernels::floatToBytes(floats.data(), channels, bytes.data(), count, 1.0f, gamma); });
+                printRow("floatToBytes", channels, gamma, set.name, scalar, vector, maxDifference(reference, bytes));
+
+                const size_t halfBytes = channels * (sizeof(uint16_t) + 1);
+                const double scalarHalf = throughput(count, set.repeats, halfBytes, [&]() { scalarHalfToBytes(halves.data(), channels, reference.data(), count, gamma); });
+                const double vectorHalf = throughput(count, set.repeats, halfBytes, [&]() { RowKernels::halfToBytes(halves.data(), channels, bytes.data(), count, 1.0f, gamma); });
+                printRow("halfToBytes", channels, gamma, set.name, scalarHalf, vectorHalf, maxDifference(reference, bytes));
+            }
+        }
+        const uint32_t values = 4 * set.pixels;
+        const size_t expandBytes = sizeof(uint16_t) + sizeof(float);
+        const double scalar = throughput(values, set.repeats, expandBytes, [&]() { scalarHalfToFloat(halves.data(), expandedReference.data(), values); });
+        const double vector = throughput(values, set.repeats, expandBytes, [&]() { RowKernels::halfToFloat(halves.data(), expanded.data(), values); });
+        const bool same = std::memcmp(expandedReference.data(), expanded.data(), values * sizeof(float)) == 0;
+        printRow("halfToFloat", 1, 1.0f, set.name, scalar, vector, same ? 0 : 1);
+    }
+}